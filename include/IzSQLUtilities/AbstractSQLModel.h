@@ -5,22 +5,32 @@
 #include <vector>
 
 #include <QFutureWatcher>
+#include <QPointer>
+#include <QSet>
 
 #include "IzModels/AbstractItemModel.h"
 
 #include "IzSQLUtilities/IzSQLUtilities_Enums.h"
 #include "IzSQLUtilities/IzSQLUtilities_Global.h"
+#include "IzSQLUtilities/SQLRefreshScheduler.h"
 #include "SQLRow.h"
 
 // TODO: przepisać normalniej funkcję validującą sql query i jego parametry
 // TODO: może jakaś abstrakcyjny interfejs dla modelu danych?
-// TODO: implementacja funkcjonalności abortLoading()
 // TODO: implementacja funkcjonalności częściowego refresh'a
 // TODO: sterowanie częstotliwością wysyłania sygnału rowsLoaded(int)
 
+class QSqlDatabase;
+class QSqlDriver;
+class QSqlQuery;
+class QTimer;
+
 namespace IzSQLUtilities
 {
     class LoadedSQLData;
+    class SQLQueryTemplate;
+    class SQLRefreshGroup;
+    class SQLSchema;
 
     class IZSQLUTILITIESSHARED_EXPORT AbstractSQLModel : public IzModels::AbstractItemModel
     {
@@ -48,6 +58,57 @@ namespace IzSQLUtilities
         // current connection parameters - empty parameters = parameter are read from dynamic properties of qApp
         Q_PROPERTY(QVariantMap connectionParameters READ connectionParameters WRITE setConnectionParameters NOTIFY connectionParametersChanged FINAL)
 
+        // path of the binary snapshot of model's data
+        Q_PROPERTY(QString snapshotPath READ snapshotPath WRITE setSnapshotPath NOTIFY snapshotPathChanged FINAL)
+
+        // if true, snapshot is written after every successful full refresh
+        Q_PROPERTY(bool autoSaveSnapshot READ autoSaveSnapshot WRITE setAutoSaveSnapshot NOTIFY autoSaveSnapshotChanged FINAL)
+
+        // if true, full refreshes are served from process wide SQLResultCache
+        Q_PROPERTY(bool cacheResults READ cacheResults WRITE setCacheResults NOTIFY cacheResultsChanged FINAL)
+
+        // if true, loaded values are kept in compact raw form and converted to QVariant on first access
+        Q_PROPERTY(bool lazyDecoding READ lazyDecoding WRITE setLazyDecoding NOTIFY lazyDecodingChanged FINAL)
+
+        // if true, fetched values are converted into rows on compute pool while next ones are fetched
+        Q_PROPERTY(bool pipelinedLoading READ pipelinedLoading WRITE setPipelinedLoading NOTIFY pipelinedLoadingChanged FINAL)
+
+        // column name -> declared type of its values: int, bool, decimal, json, date[:format], datetime[:format], time[:format]
+        // cells are coerced once, during load, and columnDataType() reports declared types
+        // WARNING: decimal is coerced to double - values with more than 15 significant digits lose precision, leave such columns undeclared to keep driver's value
+        Q_PROPERTY(QVariantMap columnTypes READ columnTypes WRITE setColumnTypes NOTIFY columnTypesChanged FINAL)
+
+        // columns skipped by full refresh - query is wrapped to select only the other ones
+        // cells of skipped columns are fetched by row key, in batches, when they are read - requires key columns of the model
+        // WARNING: query with ORDER BY at its top level is not wrapped - all of its columns are loaded
+        // WARNING: skipped cells are not loaded for snapshots, export, findRow(), filters and sorting - these refuse to use skipped columns
+        Q_PROPERTY(QStringList deferredColumns READ deferredColumns WRITE setDeferredColumns NOTIFY deferredColumnsChanged FINAL)
+
+        // if true, blob and long text columns are deferred as well
+        Q_PROPERTY(bool deferLargeColumns READ deferLargeColumns WRITE setDeferLargeColumns NOTIFY deferLargeColumnsChanged FINAL)
+
+        // if true, changes of the query, its parameters or connection parameters schedule refresh
+        Q_PROPERTY(bool autoRefresh READ autoRefresh WRITE setAutoRefresh NOTIFY autoRefreshChanged FINAL)
+
+        // scheduler used by scheduleRefresh() - can be shared by several models, model uses its own one if not set
+        Q_PROPERTY(IzSQLUtilities::SQLRefreshScheduler* refreshScheduler READ refreshScheduler WRITE setRefreshScheduler NOTIFY refreshSchedulerChanged FINAL)
+
+        // column used to split full refresh into concurrently loaded partitions - empty disables partitioned loading
+        // WARNING: partitioned query is wrapped as derived table - queries with ORDER BY are loaded without partitions, use partitionOrderBy instead
+        // column name is escaped with driver's rules - use plain column name of the result
+        Q_PROPERTY(QString partitionColumn READ partitionColumn WRITE setPartitionColumn NOTIFY partitionColumnChanged FINAL)
+
+        // number of modulo partitions - ignored if partitionBounds are set
+        Q_PROPERTY(int partitionCount READ partitionCount WRITE setPartitionCount NOTIFY partitionCountChanged FINAL)
+
+        // ascending split points of key range partitions - N bounds result in N + 1 partitions
+        Q_PROPERTY(QVariantList partitionBounds READ partitionBounds WRITE setPartitionBounds NOTIFY partitionBoundsChanged FINAL)
+
+        // order of partitioned rows as list of 'column [ASC|DESC]' - partitions are sorted by the server and k-way merged
+        // column names are escaped with driver's rules, refresh fails on entries in other format
+        // empty list results in partitions being appended one after another
+        Q_PROPERTY(QStringList partitionOrderBy READ partitionOrderBy WRITE setPartitionOrderBy NOTIFY partitionOrderByChanged FINAL)
+
     public:
         // types of data refresh
         enum class DataRefreshType : uint8_t {
@@ -60,7 +121,8 @@ namespace IzSQLUtilities
         enum class DataRefreshResult : uint8_t {
             Refreshed = 0,
             DatabaseError,
-            QueryError
+            QueryError,
+            Aborted
         };
         Q_ENUMS(DataRefreshType)
 
@@ -126,30 +188,47 @@ namespace IzSQLUtilities
         // used to refresh data, emits refreshStarted signal, uses set earlier sqlQuery and sqlQueryParameters members
         Q_INVOKABLE void refreshData();
 
+        // schedules refresh through refreshScheduler - bursts of calls result in single refresh with the latest query and parameters
+        Q_INVOKABLE void scheduleRefresh();
+
+        // aborts running refresh - current data is kept and dataRefreshEnded(false) is emitted
+        // rows are not fetched past the abort, but query already executing on the server is waited for
+        Q_INVOKABLE void abortRefresh();
+
         // used to add parameter to the query
         Q_INVOKABLE void addQueryParameter(const QString& parameter, const QVariant& value);
 
         // adds new row to sql data - returns true on success and false otherwise
         // defaultInitialize - if set to true missing columns will be initialized to its default type values
         // uniqueColumnValues - if set wil check if current set of data already has columns with given values - emits duplicateRow() on collision
-        Q_INVOKABLE bool addRow(const QVariantMap& data, bool defaultInitialize = false, const QStringList& uniqueColumnValues = {});
+        Q_INVOKABLE virtual bool addRow(const QVariantMap& data, bool defaultInitialize = false, const QStringList& uniqueColumnValues = {});
 
         // removes row from sql data - returns true on success and false otherwise
-        Q_INVOKABLE bool removeRow(int index);
+        Q_INVOKABLE virtual bool removeRow(int index);
 
         // returns true if executed query is different than the last one
         Q_INVOKABLE bool executedNewQuery() const;
 
         // returns index of the data row for which values from QVariantMap are equal or -1 if row was not found
+        // deferred columns can not be searched - -1 is returned for them
         int findRow(const QVariantMap& columnValues) const;
 
-        // returns iterators for m_data vector
+        // returns true if cells of given column were not fetched with current data - see deferredColumns
+        bool isDeferredColumn(int column) const;
+
+        // returns true if current data has deferred columns
+        bool hasDeferredColumns() const;
+
+        // returns iterators for m_data vector - rows shared with other models or SQLResultCache are copied first, as with detachRow()
+        // use cbegin() / cend() for reading
         auto begin()
         {
+            detachRows();
             return m_data.begin();
         }
         auto end()
         {
+            detachRows();
             return m_data.end();
         }
 
@@ -164,7 +243,8 @@ namespace IzSQLUtilities
         }
 
         // WARNING: absolutely no boundary checks
-        SQLRow& at(int index)
+        // rows can be shared with other models - use detachRow() to change them
+        const SQLRow& at(int index) const
         {
             return *m_data[static_cast<std::size_t>(index)];
         }
@@ -177,6 +257,7 @@ namespace IzSQLUtilities
         void setColumnNameColumnAliasMap(const QVariantMap& columnNameColumnAliasMap);
 
         // return types, as QMetaType::Type of given sql column or QMetaType::UnknownType if invalid insex was passed
+        // declared columnTypes take precedence over types reported by the driver
         QMetaType columnDataType(int index) const;
 
         // custom model interface end
@@ -199,31 +280,133 @@ namespace IzSQLUtilities
         QString databaseName() const;
         void setDatabaseName(const QString& databaseName);
 
+        // m_snapshotPath setter / getter
+        QString snapshotPath() const;
+        void setSnapshotPath(const QString& snapshotPath);
+
+        // m_autoSaveSnapshot setter / getter
+        bool autoSaveSnapshot() const;
+        void setAutoSaveSnapshot(bool autoSaveSnapshot);
+
+        // replaces model data with the snapshot from snapshotPath - values are decoded lazily from memory mapped file
+        // intended for instant warm start, followed by regular refreshData()
+        Q_INVOKABLE bool loadSnapshot();
+
+        // writes current model data to snapshotPath
+        Q_INVOKABLE bool saveSnapshot();
+
+        // replaces model data with data of other model, without copying rows
+        // rows are shared until one of the models changes them, sql query of this model is left untouched
+        // fails if any of the models loads its rows on demand, as SQLWindowedModel does
+        Q_INVOKABLE bool shareDataFrom(IzSQLUtilities::AbstractSQLModel* other);
+
+        // m_cacheResults setter / getter
+        bool cacheResults() const;
+        void setCacheResults(bool cacheResults);
+
+        // removes cached result of current query and its parameters from SQLResultCache
+        Q_INVOKABLE void invalidateCachedResult();
+
+        // m_lazyDecoding setter / getter
+        bool lazyDecoding() const;
+        void setLazyDecoding(bool lazyDecoding);
+
+        // m_pipelinedLoading setter / getter
+        bool pipelinedLoading() const;
+        void setPipelinedLoading(bool pipelinedLoading);
+
+        // m_columnTypes setter / getter
+        QVariantMap columnTypes() const;
+        void setColumnTypes(const QVariantMap& columnTypes);
+
+        // m_deferredColumns setter / getter
+        QStringList deferredColumns() const;
+        void setDeferredColumns(const QStringList& deferredColumns);
+
+        // m_deferLargeColumns setter / getter
+        bool deferLargeColumns() const;
+        void setDeferLargeColumns(bool deferLargeColumns);
+
+        // m_autoRefresh setter / getter
+        bool autoRefresh() const;
+        void setAutoRefresh(bool autoRefresh);
+
+        // m_refreshScheduler setter / getter
+        IzSQLUtilities::SQLRefreshScheduler* refreshScheduler() const;
+        void setRefreshScheduler(IzSQLUtilities::SQLRefreshScheduler* refreshScheduler);
+
+        // m_partitionColumn setter / getter
+        QString partitionColumn() const;
+        void setPartitionColumn(const QString& partitionColumn);
+
+        // m_partitionCount setter / getter
+        int partitionCount() const;
+        void setPartitionCount(int partitionCount);
+
+        // m_partitionBounds setter / getter
+        QVariantList partitionBounds() const;
+        void setPartitionBounds(const QVariantList& partitionBounds);
+
+        // m_partitionOrderBy setter / getter
+        QStringList partitionOrderBy() const;
+        void setPartitionOrderBy(const QStringList& partitionOrderBy);
+
     protected:
-        // internal data getters
-        std::vector<std::unique_ptr<SQLRow>>& internalData();
-        const std::vector<std::unique_ptr<SQLRow>>& internalData() const;
+        // internal data getters - non const one copies shared rows first, as with detachRow()
+        // WARNING: rows of the const getter can be shared - change rows only through detachRow() or the non const getter
+        std::vector<std::shared_ptr<SQLRow>>& internalData();
+        const std::vector<std::shared_ptr<SQLRow>>& internalData() const;
         const QMap<int, QString>& indexColumnMap() const;
         const QHash<QString, int>& columnIndexMap() const;
 
+        // returns true if last applied data had different column layout than the previous one
+        // allows subclasses to skip rebuilding of role names
+        bool schemaChanged() const;
+
+        // returns true if abortRefresh() was called for running refresh - to be checked by refresh tasks
+        bool abortRequested() const;
+
+        // returns row at given index, copying it first if it is shared with other models, SQLResultCache or readers on other threads
+        // WARNING: absolutely no boundary checks
+        SQLRow& detachRow(int index);
+
+        // copies all shared rows - see detachRow()
+        void detachRows();
+
+        // inserts given number of rows with values default initialized to column types at given position
+        // returns false if position is out of range or model has no columns
+        bool insertDefaultRows(int row, int count);
+
+        // returns columns identifying rows - deferred columns are not used without them
+        virtual QStringList rowKeyColumns() const;
+
+        // requests fetch of given pending cell - to be called by data() when the cell is read
+        void requestDeferredValue(int row, int column) const;
+
+        // called when pending cells of given column were fetched - emits dataChanged() for them
+        virtual void deferredValuesFetched(int column, const QList<int>& rows);
+
+        // starts full refresh of given, normalized query - returned future has to get its result on a worker thread
+        // default implementation serves the result from SQLResultCache if cacheResults is set and splits it into partitions if partitionColumn is set
+        virtual QFuture<LoadedData> startFullRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters);
+
         // allows for additiona data parsing during model refresh
         // executes post data load, right before endResetModel()
         virtual void additionalDataParsing(bool dataRefreshSucceeded);
 
-    private:
-        // internal data of the model
-        std::vector<std::unique_ptr<SQLRow>> m_data;
+        // returns true if model holds all rows of its query - models loading rows on demand can not share data nor be refreshed in groups
+        virtual bool holdsAllRows() const;
 
-        // sql column data types
-        std::vector<QMetaType> m_sqlDataTypes;
+    private:
+        // internal data of the model - rows are shared copy-on-write
+        std::vector<std::shared_ptr<SQLRow>> m_data;
 
-        // SQL column names -> indexes relations
+        // column names, indexes and types
         // contains valid values only post data load
-        QHash<QString, int> m_columnIndexMap;
+        std::shared_ptr<const SQLSchema> m_schema;
 
-        // indexes -> SQL column names relations
-        // contains valid values only post data load
-        QMap<int, QString> m_indexColumnMap;
+        // true if last applied data had different column layout than the previous one
+        bool m_schemaChanged{ true };
 
         // column names -> column aliases relations
         QVariantMap m_columnNameColumnAliasMap;
@@ -234,6 +417,9 @@ namespace IzSQLUtilities
         // raw sql query
         QString m_sqlQuery;
 
+        // parsed m_sqlQuery
+        std::shared_ptr<const SQLQueryTemplate> m_queryTemplate;
+
         // last executed sql query
         QString m_lastQuery;
 
@@ -242,10 +428,7 @@ namespace IzSQLUtilities
 
         // validates given sql query and its parameters
         // passing silent = true silences errors
-        bool validateSqlQuery(const QString& sqlQuery, const QVariantMap& sqlParameters, bool silent = false);
-
-        // normalizes parameters of the query: ':parameter' -> :parameter
-        QString normalizeSqlQuery(const QString& sqlQuery, const QVariantMap& sqlParameters) const;
+        bool validateSqlQuery(const SQLQueryTemplate& queryTemplate, const QVariantMap& sqlParameters, bool silent = false);
 
         // refresh data future watcher
         QFutureWatcher<LoadedData>* m_refreshFutureWatcher;
@@ -253,9 +436,92 @@ namespace IzSQLUtilities
         // parses loaded sql data
         void parseSQLData();
 
+        // applies result of finished refresh and emits dataRefreshEnded()
+        void applyRefreshResult(const LoadedData& loadedData);
+
+        // refresh groups load the model on their own connection
+        friend class SQLRefreshGroup;
+
+        // starts refresh driven by SQLRefreshGroup - caller checks that the model can be refreshed
+        void beginGroupRefresh();
+
+        // swaps given data into the model
+        void applyLoadedData(LoadedSQLData& sqlData);
+
+        // progress shared by queries of single refresh
+        struct FetchProgress {
+            // rows fetched so far
+            std::atomic<int> loadedRows{ 0 };
+
+            // queries which did not return yet
+            std::atomic<int> pendingQueries{ 1 };
+        };
+
+        // column projection of single refresh
+        struct Projection;
+
+        // wraps given query so it selects only not deferred columns, required columns are never deferred
+        // query is left intact if no column is deferred
+        DataRefreshResult projectQuery(const QSqlDatabase& database, QString& sqlQuery, const QVariantMap& sqlParameters, const QStringList& requiredColumns, Projection& projection);
+
+        // returns true if some columns can be deferred
+        bool defersColumns() const;
+
+        // executes given query on given connection and fetches its rows
+        LoadedData fetchQuery(const QSqlDatabase& database, const QString& sqlQuery, const QVariantMap& sqlParameters, const QString& schemaKey, const Projection& projection, FetchProgress& progress);
+
+        // fetches rows of current result set of given executed query
+        LoadedData fetchResult(QSqlQuery& query, const QString& schemaKey, const Projection& projection, FetchProgress& progress);
+
         // task for full model refresh
         LoadedData fullDataRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters);
 
+        // loads given query on given connection - shared by full and group refreshes
+        LoadedData loadData(const QSqlDatabase& database, const QString& sqlQuery, const QVariantMap& sqlParameters);
+
+        // loads current result set of given executed query - result key identifies the result set in place of the query
+        LoadedData loadResult(QSqlQuery& query, const QString& resultKey);
+
+        // updates state of the last executed query and saves snapshot of loaded data
+        void finishDataLoad(const QString& sqlQuery, const LoadedSQLData& sqlData);
+
+        // returns true if full refresh of given query is split into partitions - queries with ORDER BY are never split
+        bool isPartitioned(const QString& sqlQuery) const;
+
+        // wraps given query so it returns only rows of given partition, adds partition's parameters to sqlParameters
+        // identifiers are escaped with given driver
+        QString partitionQuery(const QSqlDriver* driver, const QString& sqlQuery, int partition, QVariantMap& sqlParameters) const;
+
+        // state of full refresh split into concurrently loaded partitions
+        struct PartitionedLoad;
+
+        // starts full refresh split into concurrently loaded partitions - no thread waits for the partitions
+        QFuture<LoadedData> startPartitionedRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters);
+
+        // resolves projection of partitioned refresh and queues its partitions - runs on the database target
+        void startPartitions(const std::shared_ptr<PartitionedLoad>& load);
+
+        // loads given partition - the last loaded one queues merge of all of them
+        void loadPartition(const std::shared_ptr<PartitionedLoad>& load, int partition);
+
+        // merges loaded partitions into single result
+        LoadedData mergePartitionedLoad(PartitionedLoad& load);
+
+        // starts full refresh bypassing SQLResultCache
+        QFuture<LoadedData> startUncachedRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters);
+
+        // starts full refresh served from SQLResultCache - waiting for load of other model does not block any thread
+        QFuture<LoadedData> startCachedRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters);
+
+        // returns SQLResultCache key of given query loaded with current load options
+        QString resultCacheKey(const QString& sqlQuery, const QVariantMap& sqlParameters) const;
+
+        // returns m_refreshScheduler or own scheduler, creating it if needed
+        SQLRefreshScheduler* activeRefreshScheduler();
+
+        // removes pending refresh of this model from the scheduler
+        void cancelScheduledRefresh();
+
         // task for partial model refresh
         LoadedData partialDataRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters, const QList<int>& rows);
 
@@ -275,6 +541,80 @@ namespace IzSQLUtilities
         // sql connection parameters
         QVariantMap m_connectionParameters;
 
+        // path of the binary snapshot of model's data
+        QString m_snapshotPath;
+
+        // if true, snapshot is written after every successful full refresh
+        bool m_autoSaveSnapshot{ false };
+
+        // if true, full refreshes are served from process wide SQLResultCache
+        bool m_cacheResults{ false };
+
+        // if true, loaded values are kept in compact raw form and converted to QVariant on first access
+        bool m_lazyDecoding{ false };
+
+        // if true, fetched values are converted into rows on compute pool while next ones are fetched
+        bool m_pipelinedLoading{ false };
+
+        // column name -> declared type of its values
+        QVariantMap m_columnTypes;
+
+        // if true, changes of the query, its parameters or connection parameters schedule refresh
+        bool m_autoRefresh{ false };
+
+        // scheduler set by the user
+        QPointer<SQLRefreshScheduler> m_refreshScheduler;
+
+        // scheduler used when m_refreshScheduler is not set - created on first use
+        SQLRefreshScheduler* m_ownRefreshScheduler{ nullptr };
+
+        // set by abortRefresh(), checked by refresh tasks
+        std::atomic<bool> m_abortRequested{ false };
+
+        // column used to split full refresh into partitions
+        QString m_partitionColumn;
+
+        // number of modulo partitions
+        int m_partitionCount{ 4 };
+
+        // split points of key range partitions
+        QVariantList m_partitionBounds;
+
+        // order of partitioned rows
+        QStringList m_partitionOrderBy;
+
+        // columns skipped by full refresh
+        QStringList m_deferredColumns;
+
+        // if true, blob and long text columns are deferred as well
+        bool m_deferLargeColumns{ false };
+
+        // query, parameters and key columns pending cells of current data are fetched with
+        QString m_deferredQuery;
+        QVariantMap m_deferredParameters;
+        QStringList m_deferredKeyColumns;
+
+        // indexes of columns not fetched with current data
+        std::vector<int> m_pendingColumns;
+
+        // column -> rows of requested pending cells
+        mutable QHash<int, QList<int>> m_deferredRequests;
+
+        // requested pending cells - row << 32 | column
+        mutable QSet<quint64> m_requestedDeferredCells;
+
+        // collects requests of single event loop turn into one fetch
+        QTimer* m_deferredFetchTimer;
+
+        // incremented whenever data is replaced - fetched cells of older data are dropped
+        quint64 m_dataGeneration{ 0 };
+
+        // fetches requested pending cells
+        void fetchDeferredValues();
+
+        // drops requests of pending cells
+        void resetDeferredValues();
+
     signals:
         // Q_PROPERTY changed signals
         void sqlQueryChanged();
@@ -282,6 +622,20 @@ namespace IzSQLUtilities
         void queryIsValidChanged();
         void databaseTypeChanged();
         void connectionParametersChanged();
+        void snapshotPathChanged();
+        void autoSaveSnapshotChanged();
+        void cacheResultsChanged();
+        void lazyDecodingChanged();
+        void pipelinedLoadingChanged();
+        void columnTypesChanged();
+        void deferredColumnsChanged();
+        void deferLargeColumnsChanged();
+        void autoRefreshChanged();
+        void refreshSchedulerChanged();
+        void partitionColumnChanged();
+        void partitionCountChanged();
+        void partitionBoundsChanged();
+        void partitionOrderByChanged();
 
         // emited when SQL query started
         void sqlQueryStarted();
@@ -297,6 +651,9 @@ namespace IzSQLUtilities
 
         // emited when, when adding new data, duplicate row was found
         void duplicateFound();
+
+        // emited when model data was replaced by the snapshot
+        void snapshotLoaded();
     };
 
 }   // namespace IzSQLUtilities
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <memory>
+
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    class SqlConnector;
+
+    // per thread cache of open database connections
+    // QSqlDatabase can only be used by the thread that created it, so every thread keeps its own connections
+    class IZSQLUTILITIESSHARED_EXPORT SQLConnectionPool
+    {
+    public:
+        // returns connection of the calling thread for given database, opening it if needed
+        // connections that could not be opened are returned, but not cached - check getConnection().isOpen()
+        static std::shared_ptr<SqlConnector> connection(DatabaseType databaseType, const QVariantMap& connectionParameters = {});
+
+        // closes connection of the calling thread for given database - use after connection errors
+        static void releaseConnection(DatabaseType databaseType, const QVariantMap& connectionParameters = {});
+
+        // closes all connections of the calling thread
+        static void releaseConnections();
+    };
+}   // namespace IzSQLUtilities
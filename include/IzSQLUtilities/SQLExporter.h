@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include <QFuture>
+#include <QObject>
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    class SQLTableProxyModel;
+
+    // streaming export of views and queries to CSV or JSON lines files
+    class IZSQLUTILITIESSHARED_EXPORT SQLExporter : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SQLExporter)
+
+        // true if export is in progress
+        Q_PROPERTY(bool isExporting READ isExporting NOTIFY isExportingChanged FINAL)
+
+        // separator of CSV fields
+        Q_PROPERTY(QString csvSeparator READ csvSeparator WRITE setCsvSeparator NOTIFY csvSeparatorChanged FINAL)
+
+    public:
+        // supported export formats
+        enum class ExportFormat : uint8_t {
+            CSV = 0,
+            JSONLines
+        };
+        Q_ENUM(ExportFormat)
+
+        // result of export
+        struct ExportResult {
+            // true if all rows were written
+            bool succeeded{ false };
+
+            // number of written rows
+            qint64 rows{ 0 };
+
+            // error of failed export
+            QString error;
+        };
+
+        // ctor
+        explicit SQLExporter(QObject* parent = nullptr);
+
+        // dtor - cancels running export and waits for its worker
+        ~SQLExporter();
+
+        // exports rows of given view, respecting its filters, sort order, hidden and excluded columns
+        // layout and rows of the view are captured on the calling thread, values are read and written on a worker thread
+        // later changes of the source model do not affect running export
+        // fails for views without visible columns
+        Q_INVOKABLE bool exportView(IzSQLUtilities::SQLTableProxyModel* view, const QString& filePath, IzSQLUtilities::SQLExporter::ExportFormat format = ExportFormat::CSV);
+
+        // exports result of given query, streamed from the cursor on SQLThreadPool
+        // parameters - query parameters, without ':'
+        Q_INVOKABLE bool exportQuery(const QString& sqlDefinition, const QVariantMap& parameters, const QString& filePath, IzSQLUtilities::SQLExporter::ExportFormat format = ExportFormat::CSV);
+
+        // cancels running export - partially written file is discarded
+        Q_INVOKABLE void cancel();
+
+        // m_isExporting getter
+        bool isExporting() const;
+
+        // m_csvSeparator getter / setter
+        QString csvSeparator() const;
+        void setCsvSeparator(const QString& csvSeparator);
+
+        // m_connectionParameters setter / getter
+        QVariantMap connectionParameters() const;
+        void setConnectionParameters(const QVariantMap& connectionParameters);
+
+        // m_databaseType setter / getter
+        IzSQLUtilities::DatabaseType databaseType() const;
+        void setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType);
+
+    private:
+        // true if export is in progress
+        bool m_isExporting{ false };
+
+        // set to request cancellation of running export
+        std::atomic<bool> m_cancelRequested{ false };
+
+        // running export worker
+        QFuture<ExportResult> m_exportFuture;
+
+        // separator of CSV fields
+        QString m_csvSeparator{ QStringLiteral(",") };
+
+        // sql database type
+        IzSQLUtilities::DatabaseType m_databaseType{ IzSQLUtilities::DatabaseType::MSSQL };
+
+        // sql connection parameters
+        QVariantMap m_connectionParameters;
+
+        // prepares exporter for new export
+        bool beginExport();
+
+        // handles export result
+        void onExportFinished(const ExportResult& result);
+
+    signals:
+        // Q_PROPERTY *Changed signals
+        void isExportingChanged();
+        void csvSeparatorChanged();
+
+        // emited periodically during export, from the worker thread - totalRows is -1 for query exports
+        void progress(qint64 rows, qint64 totalRows);
+
+        // emited when export has finished, was cancelled or failed
+        void exportFinished(bool succeeded, qint64 rows, QString error);
+    };
+}   // namespace IzSQLUtilities
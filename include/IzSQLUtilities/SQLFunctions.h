@@ -1,11 +1,18 @@
 ﻿#pragma once
 
+#include <functional>
+
 #include "IzSQLUtilities/IzSQLUtilities_Enums.h"
 #include "IzSQLUtilities/IzSQLUtilities_Global.h"
+#include "IzSQLUtilities/SQLRowBatch.h"
 
+#include <QDeadlineTimer>
+#include <QFuture>
+#include <QHash>
 #include <QObject>
 #include <QSharedPointer>
 #include <QSqlError>
+#include <QStringList>
 #include <QVariantMap>
 
 namespace IzSQLUtilities
@@ -29,12 +36,49 @@ namespace IzSQLUtilities
         // static, state less variant of the callProcedure function
         static bool callProcedureStatic(const char* functionName, const char* sqlDefinition, const QVariantMap& parameters, DatabaseType databaseType = DatabaseType::MSSQL, const QVariantMap& connectionParameters = {});
 
+        // executes given statement for every row of columnar parameter values
+        // columns - names of parameters, without ':'; columnValues - one list of values per column, all of equal length
+        // uses native batch execution when supported by the driver, otherwise reuses prepared statement
+        // transaction is commited every commitInterval rows - on failure only the current chunk is rolled back
+        Q_INVOKABLE bool bulkExecute(const QString& sqlDefinition, const QStringList& columns, const QVariantList& columnValues, int commitInterval = 10000);
+
+        // asynchronous variant of callProcedure - executed on SQLThreadPool using pooled connection
+        // operationStarted() is emited immediately, success() or failed() and operationEnded() are emited on the caller's thread
+        QFuture<bool> callProcedureAsync(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters);
+
+        // asynchronously executes given query and returns value of the first column of its first row
+        // valueReturned() is emited on the caller's thread on success
+        QFuture<QVariant> queryValueAsync(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters = {});
+
+        // asynchronous variant of objectNameAvailable - objectNameChecked() is emited on the caller's thread
+        // operationStarted() and operationEnded() are emited with the object as operation name
+        QFuture<bool> objectNameAvailableAsync(const QString& table, const QString& column, const QString& object);
+
+        // QML variants of the asynchronous functions above - QFuture is not usable from QML, results are reported only by signals
+        Q_INVOKABLE void startProcedureCall(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters);
+        Q_INVOKABLE void startValueQuery(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters = {});
+        Q_INVOKABLE void startObjectNameCheck(const QString& table, const QString& column, const QString& object);
+
+        // walks result of given query in batches of batchSize rows, without materializing it
+        // callback returns false to stop streaming; batch passed to callback is reused between calls
+        // executed on the calling thread using its own connection - see SQLQueryStream for iterator style access
+        bool streamQuery(const QString& sqlDefinition, const QVariantMap& parameters, const std::function<bool(const SQLRowBatch&)>& callback, int batchSize = 1000) const;
+
         // checks for SQL object avability in given table and column
         Q_INVOKABLE bool objectNameAvailable(const QString& table, const QString& column, const QString& object);
 
+        // checks avability of many SQL objects in given table and column
+        // uses one parameterised query per chunkSize objects and returns object -> avability relations
+        // objects are compared by the server, with column's collation
+        QHash<QString, bool> objectNamesAvailable(const QString& table, const QString& column, const QStringList& objects, int chunkSize = 500);
+
         // checks for SQL object avability in given table and column
         Q_INVOKABLE bool objectNameAvailableWithConstrain(const QString& table, const QString& column, const QString& object, const QString& type, int typeID);
 
+        // checks avability of many SQL objects in given table and column, limited to rows of given type
+        // uses one parameterised query per chunkSize objects and returns object -> avability relations - results are not cached
+        QHash<QString, bool> objectNamesAvailableWithConstrain(const QString& table, const QString& column, const QStringList& objects, const QString& type, int typeID, int chunkSize = 500);
+
         // m_connectionParameters setter / getter
         QVariantMap connectionParameters() const;
         void setConnectionParameters(const QVariantMap& connectionParameters);
@@ -43,6 +87,14 @@ namespace IzSQLUtilities
         IzSQLUtilities::DatabaseType databaseType() const;
         void setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType);
 
+        // m_availabilityCacheTimeout setter / getter
+        // time, in msecs, for which results of objectNameAvailable() and objectNamesAvailable() are reused - 0 disables cache
+        int availabilityCacheTimeout() const;
+        void setAvailabilityCacheTimeout(int availabilityCacheTimeout);
+
+        // clears cached avability results
+        Q_INVOKABLE void clearAvailabilityCache();
+
         // sql database type
         IzSQLUtilities::DatabaseType m_databaseType{ IzSQLUtilities::DatabaseType::MSSQL };
 
@@ -50,9 +102,40 @@ namespace IzSQLUtilities
         QVariantMap m_connectionParameters;
 
     private:
+        // cached avability result
+        struct AvailabilityCacheEntry {
+            // true if object was available
+            bool available;
+
+            // expiration of this entry
+            QDeadlineTimer deadline;
+        };
+
+        // time, in msecs, for which avability results are reused
+        int m_availabilityCacheTimeout{ 0 };
+
+        // table, column and object -> avability relations
+        QHash<QString, AvailabilityCacheEntry> m_availabilityCache;
+
+        // size of m_availabilityCache at which expired entries are purged
+        qsizetype m_availabilityPruneSize{ 256 };
+
         // tries to sanitize sql parameter for dynamic queries
         QString sanitize(const QString& parameter) const;
 
+        // returns key of avability cache
+        QString availabilityCacheKey(const QString& table, const QString& column, const QString& object) const;
+
+        // looks up avability cache - returns true on valid hit
+        bool cachedAvailability(const QString& key, bool& available);
+
+        // stores avability result in cache, purging expired entries once the cache doubled since the last purge
+        void cacheAvailability(const QString& key, bool available);
+
+        // checks avability of candidates with one EXISTS per candidate and one query per chunkSize candidates
+        // condition is appended to the WHERE clause with conditionValues bound after each candidate
+        bool queryAvailability(const QString& table, const QString& column, const QStringList& candidates, const QString& condition, const QVariantList& conditionValues, int chunkSize, QHash<QString, bool>& result) const;
+
     signals:
         // emited when procedure successfully finished
         void success(QString operation);
@@ -62,5 +145,17 @@ namespace IzSQLUtilities
 
         // emited when function have ended
         void operationEnded(QString operation);
+
+        // emited when asynchronous operation failed
+        void failed(QString operation, QString error);
+
+        // emited when queryValueAsync() returned value
+        void valueReturned(QString operation, QVariant value);
+
+        // emited when objectNameAvailableAsync() finished
+        void objectNameChecked(QString object, bool available);
+
+        // emited when bulkExecute() finished - rows is the number of commited rows
+        void bulkExecuted(int rows, double rowsPerSecond);
     };
 }   // namespace IzSQLUtilities
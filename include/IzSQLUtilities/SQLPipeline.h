@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include <vector>
+
+#include <QFuture>
+#include <QObject>
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+class QSqlDatabase;
+
+namespace IzSQLUtilities
+{
+    // unit of work - executes enqueued calls in order, on one connection, inside one transaction
+    class IZSQLUTILITIESSHARED_EXPORT SQLPipeline : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SQLPipeline)
+
+        // number of enqueued calls
+        Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+
+        // true if pipeline is currently executing
+        Q_PROPERTY(bool isRunning READ isRunning NOTIFY isRunningChanged FINAL)
+
+    public:
+        // single enqueued call
+        struct Call {
+            // name of the call - used in logs and signals
+            QString functionName;
+
+            // sql definition of the call
+            QString sqlDefinition;
+
+            // parameters of the call, without ':'
+            QVariantMap parameters;
+        };
+
+        // result of pipeline execution
+        struct Result {
+            // true if all calls succeeded and transaction was commited
+            bool succeeded{ false };
+
+            // name of the call that failed
+            QString failedOperation;
+
+            // error of the failed call
+            QString error;
+
+            // true if the call failed on a broken connection
+            bool connectionLost{ false };
+        };
+
+        // ctor
+        explicit SQLPipeline(QObject* parent = nullptr);
+
+        // dtor
+        ~SQLPipeline() = default;
+
+        // enqueues call - calls are executed in order of enqueueing
+        Q_INVOKABLE void enqueue(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters = {});
+
+        // removes all enqueued calls
+        Q_INVOKABLE void clear();
+
+        // executes enqueued calls - all or nothing, emits finished()
+        // queue is cleared on success and left intact on failure
+        Q_INVOKABLE bool exec();
+
+        // asynchronous variant of exec - executed on SQLThreadPool, finished() is emited on the caller's thread
+        Q_INVOKABLE QFuture<bool> execAsync();
+
+        // m_calls size getter
+        int count() const;
+
+        // m_isRunning getter
+        bool isRunning() const;
+
+        // m_connectionParameters setter / getter
+        QVariantMap connectionParameters() const;
+        void setConnectionParameters(const QVariantMap& connectionParameters);
+
+        // m_databaseType setter / getter
+        IzSQLUtilities::DatabaseType databaseType() const;
+        void setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType);
+
+        // executes given calls on given connection - statements with identical sql are prepared once
+        static Result execCalls(QSqlDatabase& database, const std::vector<Call>& calls);
+
+    private:
+        // enqueued calls
+        std::vector<Call> m_calls;
+
+        // true if pipeline is currently executing
+        bool m_isRunning{ false };
+
+        // sql database type
+        IzSQLUtilities::DatabaseType m_databaseType{ IzSQLUtilities::DatabaseType::MSSQL };
+
+        // sql connection parameters
+        QVariantMap m_connectionParameters;
+
+        // handles execution result
+        bool onExecuted(const Result& result);
+
+        // m_isRunning setter
+        void setIsRunning(bool isRunning);
+
+    signals:
+        // Q_PROPERTY *Changed signals
+        void countChanged();
+        void isRunningChanged();
+
+        // emited when execution has finished
+        void finished(bool succeeded, QString failedOperation, QString error);
+    };
+}   // namespace IzSQLUtilities
@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <memory>
+
+#include <QSqlError>
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+#include "IzSQLUtilities/SQLRowBatch.h"
+
+class QSqlQuery;
+
+namespace IzSQLUtilities
+{
+    class SqlConnector;
+
+    // forward only, batched reader of query results
+    // uses its own connection - streams can be nested or interleaved on one thread, also on MSSQL without MARS
+    // connection is opened by exec() and closed once the stream is exhausted - whole stream has to be consumed by one thread
+    class IZSQLUTILITIESSHARED_EXPORT SQLQueryStream
+    {
+    public:
+        // ctor
+        // parameters - query parameters, without ':'
+        explicit SQLQueryStream(const QString& sqlDefinition, const QVariantMap& parameters = {}, int batchSize = 1000,
+                                DatabaseType databaseType = DatabaseType::MSSQL, const QVariantMap& connectionParameters = {});
+
+        // dtor
+        ~SQLQueryStream();
+
+        SQLQueryStream(const SQLQueryStream& other) = delete;
+        SQLQueryStream(SQLQueryStream&& other) = delete;
+
+        // executes query - returns false on error
+        bool exec();
+
+        // fetches next batch of rows into batch() - returns false if no rows are left or on error
+        bool next();
+
+        // returns current batch
+        // WARNING: batch storage is reused by next()
+        const SQLRowBatch& batch() const;
+
+        // returns number of rows fetched so far
+        qint64 fetchedRows() const;
+
+        // returns last error
+        QSqlError lastError() const;
+
+    private:
+        // query definition
+        QString m_sqlDefinition;
+
+        // query parameters
+        QVariantMap m_parameters;
+
+        // maximum number of rows in a batch
+        int m_batchSize;
+
+        // sql database type
+        DatabaseType m_databaseType;
+
+        // sql connection parameters
+        QVariantMap m_connectionParameters;
+
+        // connection of the stream
+        std::unique_ptr<SqlConnector> m_connection;
+
+        // executed query
+        std::unique_ptr<QSqlQuery> m_query;
+
+        // current batch
+        SQLRowBatch m_batch;
+
+        // number of rows fetched so far
+        qint64 m_fetchedRows{ 0 };
+
+        // last error
+        QSqlError m_lastError;
+    };
+}   // namespace IzSQLUtilities
@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    class AbstractSQLModel;
+
+    // refreshes several models of the same database together
+    // queries of the models run back to back on one connection, inside one read only transaction, so all models see the same snapshot of the data
+    // new data of all models is applied in the same event loop turn
+    // WARNING: members are loaded with plain full refresh - partitioning and result cache of the models are not used
+    // WARNING: consistent snapshot on MSSQL requires ALLOW_SNAPSHOT_ISOLATION enabled on the database
+    // WARNING: models can not be destroyed while the group is refreshing
+    class IZSQLUTILITIESSHARED_EXPORT SQLRefreshGroup : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SQLRefreshGroup)
+
+        // number of models in the group
+        Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+
+        // true if group is currently refreshing
+        Q_PROPERTY(bool isRefreshing READ isRefreshing NOTIFY isRefreshingChanged FINAL)
+
+        // if true, queries run inside one transaction with snapshot isolation - false by default
+        // WARNING: MSSQL database has to allow snapshot isolation, PSQL transaction of model queries is read only
+        Q_PROPERTY(bool consistentSnapshot READ consistentSnapshot WRITE setConsistentSnapshot NOTIFY consistentSnapshotChanged FINAL)
+
+        // batch query returning several result sets, e.g. stored procedure call - n-th result set is loaded into n-th model
+        // if set, queries of the models are not executed - whole group is loaded with one execution of the batch
+        // results without columns, e.g. row counts of statements preceding the selects, are skipped
+        // parameters of the batch follow conventions of model's queries: ':parameter'
+        Q_PROPERTY(QString sqlQuery READ sqlQuery WRITE setSqlQuery NOTIFY sqlQueryChanged FINAL)
+
+        // parameters of the batch query
+        Q_PROPERTY(QVariantMap sqlQueryParameters READ sqlQueryParameters WRITE setSqlQueryParameters NOTIFY sqlQueryParametersChanged FINAL)
+
+    public:
+        // ctor
+        explicit SQLRefreshGroup(QObject* parent = nullptr);
+
+        // dtor
+        ~SQLRefreshGroup() = default;
+
+        // adds model to the group - models are loaded in order of adding
+        // models loading rows on demand, as SQLWindowedModel, are rejected
+        Q_INVOKABLE void addModel(IzSQLUtilities::AbstractSQLModel* model);
+
+        // removes model from the group
+        Q_INVOKABLE void removeModel(IzSQLUtilities::AbstractSQLModel* model);
+
+        // removes all models from the group
+        Q_INVOKABLE void clear();
+
+        // starts refresh of all models - emits refreshEnded() once new data of all models is applied
+        // returns false if some model can not be refreshed now, or models use different databases
+        Q_INVOKABLE bool refresh();
+
+        // aborts running refresh - all models keep their current data
+        Q_INVOKABLE void abort();
+
+        // m_models size getter
+        int count() const;
+
+        // m_isRefreshing getter
+        bool isRefreshing() const;
+
+        // m_consistentSnapshot getter / setter
+        bool consistentSnapshot() const;
+        void setConsistentSnapshot(bool consistentSnapshot);
+
+        // m_sqlQuery getter / setter
+        QString sqlQuery() const;
+        void setSqlQuery(const QString& sqlQuery);
+
+        // m_sqlQueryParameters getter / setter
+        QVariantMap sqlQueryParameters() const;
+        void setSqlQueryParameters(const QVariantMap& sqlQueryParameters);
+
+    private:
+        // models of the group
+        QList<QPointer<AbstractSQLModel>> m_models;
+
+        // true if group is currently refreshing
+        bool m_isRefreshing{ false };
+
+        // if true, queries run inside one transaction with snapshot isolation
+        bool m_consistentSnapshot{ false };
+
+        // batch query returning result sets of all models
+        QString m_sqlQuery;
+
+        // parameters of the batch query
+        QVariantMap m_sqlQueryParameters;
+
+        // m_isRefreshing setter
+        void setIsRefreshing(bool isRefreshing);
+
+    signals:
+        // Q_PROPERTY *Changed signals
+        void countChanged();
+        void isRefreshingChanged();
+        void consistentSnapshotChanged();
+        void sqlQueryChanged();
+        void sqlQueryParametersChanged();
+
+        // emited when refresh of the group has started
+        void refreshStarted();
+
+        // emited when new data of all models was applied
+        void refreshEnded(bool succeeded);
+    };
+}   // namespace IzSQLUtilities
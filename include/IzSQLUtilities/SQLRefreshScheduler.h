@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+class QTimer;
+
+namespace IzSQLUtilities
+{
+    class AbstractSQLModel;
+
+    // coalesces refresh requests of one or more models
+    // bursts of requests are debounced per model, and model which is still loading gets at most one pending refresh
+    // pending refresh always uses current query and parameters of the model - the latest request wins
+    class IZSQLUTILITIESSHARED_EXPORT SQLRefreshScheduler : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SQLRefreshScheduler)
+
+        // time, in msecs, the scheduler waits for requests to settle
+        Q_PROPERTY(int debounceInterval READ debounceInterval WRITE setDebounceInterval NOTIFY debounceIntervalChanged FINAL)
+
+        // if true, running refresh of a model with pending refresh is aborted
+        Q_PROPERTY(bool abortRunning READ abortRunning WRITE setAbortRunning NOTIFY abortRunningChanged FINAL)
+
+    public:
+        // ctor
+        explicit SQLRefreshScheduler(QObject* parent = nullptr);
+
+        // dtor
+        ~SQLRefreshScheduler() = default;
+
+        // schedules refresh of given model
+        Q_INVOKABLE void schedule(IzSQLUtilities::AbstractSQLModel* model);
+
+        // removes pending refresh of given model
+        Q_INVOKABLE void cancel(IzSQLUtilities::AbstractSQLModel* model);
+
+        // returns true if refresh of given model is pending
+        Q_INVOKABLE bool isPending(IzSQLUtilities::AbstractSQLModel* model) const;
+
+        // m_debounceInterval getter / setter
+        int debounceInterval() const;
+        void setDebounceInterval(int debounceInterval);
+
+        // m_abortRunning getter / setter
+        bool abortRunning() const;
+        void setAbortRunning(bool abortRunning);
+
+    private:
+        // time, in msecs, the scheduler waits for requests to settle
+        int m_debounceInterval{ 100 };
+
+        // model -> its debounce timer
+        QHash<AbstractSQLModel*, QTimer*> m_debounceTimers;
+
+        // models with pending refresh, in order of requests
+        QList<QPointer<AbstractSQLModel>> m_pendingModels;
+
+        // models this scheduler is connected to
+        QSet<AbstractSQLModel*> m_connectedModels;
+
+        // if true, running refresh of a model with pending refresh is aborted
+        bool m_abortRunning{ false };
+
+        // returns debounce timer of given model, creating it if needed
+        QTimer* debounceTimer(AbstractSQLModel* model);
+
+        // starts pending refresh of given model if it is not loading
+        void startPendingRefresh(AbstractSQLModel* model);
+
+    signals:
+        // Q_PROPERTY *Changed signals
+        void debounceIntervalChanged();
+        void abortRunningChanged();
+    };
+}   // namespace IzSQLUtilities
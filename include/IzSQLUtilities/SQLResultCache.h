@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <QFuture>
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    class LoadedSQLData;
+
+    // process wide cache of loaded query results, shared by all models
+    // entries expire after timeToLive() and least recently used ones are evicted when memoryBudget() is exceeded
+    // concurrent requests for the same, not yet cached, key are collapsed into single load
+    class IZSQLUTILITIESSHARED_EXPORT SQLResultCache
+    {
+    public:
+        // function starting load of data for cache miss - its future returns nullptr on error, errors are not cached
+        using Loader = std::function<QFuture<std::shared_ptr<LoadedSQLData>>()>;
+
+        // returns key identifying given query results - load options (declared column types, deferred columns) change loaded values, so they are part of the key
+        static QString key(const QString& sqlQuery, const QVariantMap& sqlParameters, DatabaseType databaseType, const QVariantMap& connectionParameters, const QVariantMap& loadOptions = {});
+
+        // returns future of cached data for given key or starts loader and caches its result
+        // if given key is already being loaded, returns future of that load instead of starting loader - no thread is blocked waiting for it
+        // returned future always gets a result - nullptr if the load failed, threw or was cancelled
+        // WARNING: returned data is shared - it has to be copied before any change
+        static QFuture<std::shared_ptr<const LoadedSQLData>> fetch(const QString& key, const Loader& loader);
+
+        // removes entry for given key
+        static void remove(const QString& key);
+
+        // removes all entries
+        static void clear();
+
+        // time to live of new entries, in msecs - 60000 by default
+        static int timeToLive();
+        static void setTimeToLive(int timeToLive);
+
+        // approximate memory budget of the cache, in bytes - 64 MiB by default
+        static qint64 memoryBudget();
+        static void setMemoryBudget(qint64 memoryBudget);
+
+        // approximate memory used by cached data, in bytes
+        static qint64 usedMemory();
+
+        // number of requests served from the cache, including ones collapsed into pending load
+        static quint64 hits();
+
+        // number of requests which had to load data
+        static quint64 misses();
+
+        // number of entries removed due to expiration or memory budget
+        static quint64 evictions();
+    };
+}   // namespace IzSQLUtilities
@@ -1,10 +1,16 @@
 ﻿#pragma once
 
 #include <cstdio>
+#include <memory>
 #include <vector>
 
+#include <QHash>
+#include <QList>
+#include <QMutex>
 #include <QVariant>
 
+#include "IzSQLUtilities/SQLRowSource.h"
+
 namespace IzSQLUtilities
 {
     class SQLRow
@@ -13,6 +19,13 @@ namespace IzSQLUtilities
         // ctor
         SQLRow(std::size_t size);
 
+        // ctor - lazy row, values are decoded from given source on first access and memoized
+        SQLRow(std::size_t size, std::shared_ptr<const SQLRowSource> source, std::size_t sourceRow);
+
+        // copy ctor / assignment - deep copies change state
+        SQLRow(const SQLRow& other);
+        SQLRow& operator=(const SQLRow& other);
+
         // dtor
         ~SQLRow() = default;
 
@@ -20,16 +33,100 @@ namespace IzSQLUtilities
         void addColumnValue(const QVariant& value);
 
         // sets column to given value
+        // post load changes are tracked - see isDirty()
         bool setColumnValue(int index, const QVariant& value);
 
         // returns column data for given index
         QVariant columnValue(int index) const;
 
+        // returns true if any of the row's columns were changed post load
+        bool isDirty() const;
+
+        // returns true if given column was changed post load
+        bool isDirty(int index) const;
+
+        // returns indexes of columns changed post load
+        QList<int> dirtyColumns() const;
+
+        // returns value loaded for given column, regardless of post load changes
+        QVariant originalValue(int index) const;
+
+        // true if row was added by post load means
+        bool isAdded() const;
+        void setAdded(bool added);
+
+        // true if row was marked as being to be removed from external data set
+        bool toBeRemoved() const;
+        void setToBeRemoved(bool toBeRemoved);
+
+        // accepts current values as loaded ones and clears change state
+        void clearChanges();
+
+        // returns source of lazy row or nullptr
+        const SQLRowSource* source() const;
+
+        // returns dictionary code of given column in source() or -1 if the value is not dictionary encoded or was changed
+        int dictionaryCode(int index) const;
+
+        // returns index of this row in source() or -1 if the row is not lazy or value of given column was changed or fetched later
+        qint64 sourceRow(int index) const;
+
+        // marks given columns as not fetched yet - their values are fetched on demand by the model
+        void setPending(const std::vector<int>& indexes);
+
+        // returns true if value of given column was not fetched yet
+        bool isPending(int index) const;
+
+        // sets value of pending column - value is not tracked as change
+        void setFetchedValue(int index, const QVariant& value);
+
     private:
+        // state of row's cell - eager rows track only pending cells
+        enum class CellState : quint8 {
+            Encoded = 0,
+            Decoded,
+            Changed,
+            Pending,
+            Fetched
+        };
+
+        // post load change state of the row
+        struct RowChanges {
+            // true if row was added by post load means
+            bool added{ false };
+
+            // true if row was marked for removal
+            bool toBeRemoved{ false };
+
+            // column index -> loaded value of changed columns
+            QHash<int, QVariant> originalValues;
+        };
+
         // size of sql row of data -> number of columns
         std::size_t m_size;
 
-        // sql column values
-        std::vector<QVariant> m_rowData;
+        // sql column values - for lazy rows filled on first access
+        mutable std::vector<QVariant> m_rowData;
+
+        // source of lazy row values
+        std::shared_ptr<const SQLRowSource> m_source;
+
+        // index of this row in m_source
+        std::size_t m_sourceRow{ 0 };
+
+        // states of lazy row's cells, for eager rows allocated only if they have pending cells
+        mutable std::vector<CellState> m_cellStates;
+
+        // guards decoding of lazy row - rows are read by both GUI and worker threads
+        mutable QBasicMutex m_decodeMutex;
+
+        // change state - allocated on first change
+        std::unique_ptr<RowChanges> m_changes;
+
+        // returns change state, allocating it if needed
+        RowChanges& changes();
+
+        // decodes given column of lazy row if needed - m_decodeMutex has to be locked
+        void decode(int index) const;
     };
 }   // namespace IzSQLUtilities
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <vector>
+
+#include <QStringList>
+#include <QVariant>
+
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    // reusable, row major block of streamed query values
+    class IZSQLUTILITIESSHARED_EXPORT SQLRowBatch
+    {
+    public:
+        // ctor
+        SQLRowBatch() = default;
+
+        // dtor
+        ~SQLRowBatch() = default;
+
+        // prepares batch for given columns - storage is reused when the shape does not change
+        void reset(const QStringList& columnNames, int capacity);
+
+        // m_rowCount setter
+        // WARNING: rowCount cannot exceed capacity passed to reset()
+        void setRowCount(int rowCount);
+
+        // returns number of rows in batch
+        int rowCount() const;
+
+        // returns number of columns in batch
+        int columnCount() const;
+
+        // returns names of batch columns
+        const QStringList& columnNames() const;
+
+        // returns value of given cell
+        // WARNING: absolutely no boundary checks
+        inline const QVariant& value(int row, int column) const
+        {
+            return m_values[static_cast<std::size_t>(row) * static_cast<std::size_t>(m_columnNames.size()) + static_cast<std::size_t>(column)];
+        }
+
+        // returns writable value of given cell
+        // WARNING: absolutely no boundary checks
+        inline QVariant& value(int row, int column)
+        {
+            return m_values[static_cast<std::size_t>(row) * static_cast<std::size_t>(m_columnNames.size()) + static_cast<std::size_t>(column)];
+        }
+
+    private:
+        // names of batch columns
+        QStringList m_columnNames;
+
+        // cell values - row major, sized for batch capacity
+        std::vector<QVariant> m_values;
+
+        // number of valid rows
+        int m_rowCount{ 0 };
+    };
+}   // namespace IzSQLUtilities
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <QVariant>
+
+namespace IzSQLUtilities
+{
+    // source of lazily decoded row values - shared by all rows decoded from it
+    // WARNING: implementations have to be safe for concurrent value() calls
+    class SQLRowSource
+    {
+    public:
+        // dtor
+        virtual ~SQLRowSource() = default;
+
+        // decodes value of given cell
+        virtual QVariant value(std::size_t row, int column) const = 0;
+
+        // returns approximate memory used by the source, in bytes
+        virtual qint64 estimatedSize() const = 0;
+
+        // returns number of distinct values of dictionary encoded column or 0 if column is not dictionary encoded
+        virtual int dictionarySize(int column) const
+        {
+            Q_UNUSED(column)
+            return 0;
+        }
+
+        // returns dictionary code of given cell or -1 if the cell is not dictionary encoded
+        virtual int dictionaryCode(std::size_t row, int column) const
+        {
+            Q_UNUSED(row)
+            Q_UNUSED(column)
+            return -1;
+        }
+
+        // returns value of given dictionary code
+        virtual QVariant dictionaryValue(int column, int code) const
+        {
+            Q_UNUSED(column)
+            Q_UNUSED(code)
+            return {};
+        }
+
+        // returns position of given dictionary code in case sensitive order of column's distinct values
+        virtual int dictionaryRank(int column, int code) const
+        {
+            Q_UNUSED(column)
+            return code;
+        }
+
+        // evaluates inclusive [from, to] range of given column for every row of the source, null bound means unbounded
+        // null cells never match, returns empty vector if the column can not be evaluated without decoding
+        virtual std::vector<bool> rangeMatches(int column, const QVariant& from, const QVariant& to) const
+        {
+            Q_UNUSED(column)
+            Q_UNUSED(from)
+            Q_UNUSED(to)
+            return {};
+        }
+    };
+}   // namespace IzSQLUtilities
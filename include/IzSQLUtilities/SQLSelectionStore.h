@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <QList>
+
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    // dense, bitmap based selection state keyed by source row
+    class IZSQLUTILITIESSHARED_EXPORT SQLSelectionStore
+    {
+    public:
+        // ctor
+        SQLSelectionStore() = default;
+
+        // dtor
+        ~SQLSelectionStore() = default;
+
+        // returns number of rows tracked by this store
+        int size() const;
+
+        // resizes store to given number of rows - new rows are not selected
+        void resize(int size);
+
+        // inserts count of not selected rows before given row
+        void insertRows(int row, int count);
+
+        // removes count of rows starting at given row
+        void removeRows(int row, int count);
+
+        // returns true if given row is selected
+        // WARNING: absolutely no boundary checks
+        inline bool isSelected(int row) const
+        {
+            return (m_words[static_cast<std::size_t>(row) >> 6] >> (static_cast<std::size_t>(row) & 63)) & 1U;
+        }
+
+        // sets selection state of given row - returns true if state was changed
+        bool setSelected(int row, bool selected);
+
+        // sets selection state of rows in range [first, last] - returns true if any state was changed
+        bool setRangeSelected(int first, int last, bool selected);
+
+        // selects all rows
+        void selectAll();
+
+        // deselects all rows
+        void clear();
+
+        // inverts selection state of all rows
+        void invert();
+
+        // returns number of selected rows
+        int selectedCount() const;
+
+        // returns selected rows in ascending order
+        QList<int> selectedRows() const;
+
+    private:
+        // number of tracked rows
+        int m_size{ 0 };
+
+        // selection bits - 64 rows per word, bits past m_size are always zero
+        std::vector<std::uint64_t> m_words;
+
+        // zeroes bits past m_size in the last word
+        void clearTrailingBits();
+    };
+}   // namespace IzSQLUtilities
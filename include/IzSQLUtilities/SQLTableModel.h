@@ -2,6 +2,7 @@
 
 #include "AbstractSQLModel.h"
 #include "IzSQLUtilities/IzSQLUtilities_Global.h"
+#include "IzSQLUtilities/SQLSelectionStore.h"
 
 namespace IzSQLUtilities
 {
@@ -10,6 +11,15 @@ namespace IzSQLUtilities
         Q_OBJECT
         Q_DISABLE_COPY(SQLTableModel)
 
+        // name of the table to which changes are submitted
+        Q_PROPERTY(QString tableName READ tableName WRITE setTableName NOTIFY tableNameChanged FINAL)
+
+        // columns identifying a row in tableName - used by submitted UPDATE and DELETE statements
+        Q_PROPERTY(QStringList keyColumns READ keyColumns WRITE setKeyColumns NOTIFY keyColumnsChanged FINAL)
+
+        // number of rows executed as one batch during submitChanges()
+        Q_PROPERTY(int submitChunkSize READ submitChunkSize WRITE setSubmitChunkSize NOTIFY submitChunkSizeChanged FINAL)
+
     public:
         enum class SQLTableModelRoles : int {
             // defined for consistency in implementation of data() function
@@ -41,7 +51,7 @@ namespace IzSQLUtilities
         bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
         Qt::ItemFlags flags(const QModelIndex& index) const override;
 
-        // add data
+        // add data - inserted rows are default initialized and marked as added
         bool insertRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
         bool insertColumns(int column, int count, const QModelIndex& parent = QModelIndex()) override;
 
@@ -54,7 +64,102 @@ namespace IzSQLUtilities
         // AbstractSQLModel interface start
 
         void additionalDataParsing(bool dataRefreshSucceeded) override;
+        QStringList rowKeyColumns() const override;
 
         // AbstractSQLModel interface end
+
+        // m_tableName getter / setter
+        QString tableName() const;
+        void setTableName(const QString& tableName);
+
+        // m_keyColumns getter / setter
+        QStringList keyColumns() const;
+        void setKeyColumns(const QStringList& keyColumns);
+
+        // m_submitChunkSize getter / setter
+        int submitChunkSize() const;
+        void setSubmitChunkSize(int submitChunkSize);
+
+        // returns true if model has changes not yet submitted
+        Q_INVOKABLE bool hasChanges() const;
+
+        // writes added, changed and removed rows back to tableName in one transaction
+        // statements are grouped and executed in batches of submitChunkSize rows
+        // emits changesSubmitted() on success and submitFailed() otherwise
+        // submitFailed() reports the failed row - with drivers supporting native batch execution all rows of the failed chunk are reported
+        // NULL columns of added rows are left to database defaults - single generated key column is read back if driver supports it
+        // rows with NULL key values can not be updated nor deleted - submit fails with them reported
+        Q_INVOKABLE bool submitChanges();
+
+        // returns true if given row is selected
+        Q_INVOKABLE bool isRowSelected(int row) const;
+
+        // sets selection state of given row
+        Q_INVOKABLE void setRowSelected(int row, bool selected);
+
+        // sets selection state of rows in range [first, last]
+        Q_INVOKABLE void setRowRangeSelected(int first, int last, bool selected);
+
+        // sets selection state of given, not necessarily contiguous, rows
+        Q_INVOKABLE void setRowsSelected(const QList<int>& rows, bool selected);
+
+        // selects all rows
+        Q_INVOKABLE void selectAll();
+
+        // deselects all rows
+        Q_INVOKABLE void clearSelection();
+
+        // inverts selection of all rows
+        Q_INVOKABLE void invertSelection();
+
+        // returns selected rows in ascending order
+        Q_INVOKABLE QList<int> selectedRows() const;
+
+        // returns number of selected rows
+        Q_INVOKABLE int selectedRowsCount() const;
+
+        // m_selection getter
+        const SQLSelectionStore& selectionStore() const;
+
+    private:
+        // selection state of rows
+        SQLSelectionStore m_selection;
+
+        // name of the table to which changes are submitted
+        QString m_tableName;
+
+        // columns identifying a row in m_tableName
+        QStringList m_keyColumns;
+
+        // number of rows executed as one batch
+        int m_submitChunkSize{ 500 };
+
+        // loaded values of rows removed from the model - waiting for submitChanges()
+        QList<QVariantList> m_removedRows;
+
+        // true if submitChanges() is in progress
+        bool m_submitting{ false };
+
+        // records removed rows as pending deletes
+        void onRowsAboutToBeRemoved(int first, int last);
+
+        // emits dataChanged() for IsSelected role in range [first, last]
+        void notifySelectionChanged(int first, int last);
+
+    signals:
+        // Q_PROPERTY *Changed signals
+        void tableNameChanged();
+        void keyColumnsChanged();
+        void submitChunkSizeChanged();
+
+        // emited when selection state of any row was changed
+        void selectionChanged();
+
+        // emited when all changes were submitted
+        void changesSubmitted();
+
+        // emited when submitChanges() failed and all its changes were rolled back
+        // errors - list of maps with row (-1 for rows already removed from the model), operation and error keys
+        void submitFailed(const QVariantList& errors);
     };
 }   // namespace IzSQLUtilities
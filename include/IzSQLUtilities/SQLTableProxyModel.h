@@ -2,11 +2,14 @@
 
 #include "IzSQLUtilities/IzSQLUtilities_Global.h"
 
+#include <vector>
+
 #include <QFutureWatcher>
 #include <QRegularExpression>
 #include <QSet>
 #include <QSortFilterProxyModel>
 
+class QItemSelection;
 class QItemSelectionModel;
 
 // TODO: należałoby pozbyć się QItemSelectionModel'u z tego poziomu
@@ -14,6 +17,7 @@ class QItemSelectionModel;
 
 namespace IzSQLUtilities
 {
+    class SQLRowSource;
     class SQLTableModel;
 
     class IZSQLUTILITIESSHARED_EXPORT SQLTableProxyModel : public QSortFilterProxyModel
@@ -32,9 +36,11 @@ namespace IzSQLUtilities
 
         // QSortFilterProxyModel interface start
 
-        QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
         void setSourceModel(QAbstractItemModel* sourceModel) override;
 
+        // refuses to sort by deferred column of the source - its cells are not loaded
+        void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
         // QSortFilterProxyModel end
 
         // QAbstractItemModel interface start
@@ -47,9 +53,16 @@ namespace IzSQLUtilities
         Q_INVOKABLE IzSQLUtilities::SQLTableModel* source() const;
 
         // m_selectionModel getter / setter
+        // selection changes of given selection model are mirrored into the source model's selection store
         QItemSelectionModel* selectionModel() const;
         void setSelectionModel(QItemSelectionModel* selectionModel);
 
+        // sets selection state of given proxy row
+        Q_INVOKABLE void setRowSelected(int proxyRow, bool selected);
+
+        // selects all rows accepted by current filters
+        Q_INVOKABLE void selectFiltered();
+
         // changes visibility of given column
         void changeColumnVisibilitiy(int column, bool visibility);
 
@@ -65,7 +78,14 @@ namespace IzSQLUtilities
         // removes filter for column
         void removeColumnFilter(int column);
 
-        // clears column filters
+        // adds inclusive [from, to] range filter for column, null bound means unbounded
+        // packed integral, date and time columns are evaluated on their blocks without decoding cells
+        void addColumnRangeFilter(int column, const QVariant& from, const QVariant& to);
+
+        // removes range filter for column
+        void removeColumnRangeFilter(int column);
+
+        // clears column filters and range filters
         void clearColumnFilters();
 
         // m_excludedColumns getter / setter
@@ -98,12 +118,19 @@ namespace IzSQLUtilities
         QSet<int> hiddenColumns() const;
         void setHiddenColumns(const QSet<int>& hiddenColumns);
 
+        // defers loading of hidden and excluded columns of the source - applied by the next refresh
+        // cells of deferred columns are fetched when they become visible
+        Q_INVOKABLE void deferInvisibleColumns();
+
     protected:
         // QSortFilterProxyModel start
 
         bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override;
         bool filterAcceptsColumn(int source_column, const QModelIndex& source_parent) const override;
 
+        // compares dictionary encoded strings by their codes, rows of deferred columns keep source order
+        bool lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const override;
+
         // QSortFilterProxyModel end
 
     private:
@@ -114,6 +141,12 @@ namespace IzSQLUtilities
         // WARNING: this is used as a hack to implement selection functionality under QML
         QItemSelectionModel* m_selectionModel{ nullptr };
 
+        // mirrors selection model changes into the source model's selection store
+        void onSelectionModelChanged(const QItemSelection& selected, const QItemSelection& deselected);
+
+        // returns source rows covered by given proxy selection
+        QList<int> sourceRows(const QItemSelection& selection) const;
+
         // set of hidden columns
         QSet<int> m_hiddenColumns;
 
@@ -139,6 +172,24 @@ namespace IzSQLUtilities
         // WARNING: this member is used during filter operation
         QHash<int, QRegularExpression> m_cachedFilters;
 
+        // column range filters
+        QHash<int, QPair<QVariant, QVariant>> m_rangeFilters;
+
+        // cached column range filters
+        // WARNING: this member is used during filter operation
+        QHash<int, QPair<QVariant, QVariant>> m_cachedRangeFilters;
+
+        // column -> range filter results of m_cachedDictionarySource rows
+        // WARNING: this member is used during filter operation
+        QHash<int, std::vector<bool>> m_cachedRangeMatches;
+
+        // column -> filter results of its dictionary codes
+        // WARNING: this member is used during filter operation
+        QHash<int, std::vector<bool>> m_cachedDictionaryMatches;
+
+        // row source the dictionary codes of m_cachedDictionaryMatches and rows of m_cachedRangeMatches belong to
+        const SQLRowSource* m_cachedDictionarySource{ nullptr };
+
         // true if filter were applied
         bool m_filtersApplied{ false };
 
@@ -0,0 +1,99 @@
+﻿#pragma once
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QVariantMap>
+
+#include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+namespace IzSQLUtilities
+{
+    class IZSQLUTILITIESSHARED_EXPORT SQLThreadPool
+    {
+    public:
+        // priority classes of database tasks
+        enum class Priority : uint8_t {
+            Background = 0,
+            Interactive
+        };
+
+        // statistics of tasks started through run()
+        struct Metrics {
+            // tasks waiting for a thread or for their target's concurrency limit
+            int queuedTasks{ 0 };
+
+            // tasks being executed
+            int runningTasks{ 0 };
+
+            // tasks started so far
+            quint64 startedTasks{ 0 };
+
+            // sum of tasks' wait times, in usecs
+            qint64 totalWaitTime{ 0 };
+
+            // longest wait time of a task, in usecs
+            qint64 maxWaitTime{ 0 };
+        };
+
+        // returns library owned thread pool dedicated to database work
+        // threads of this pool never expire so their pooled connections stay open
+        static QThreadPool* instance();
+
+        // returns library owned thread pool for CPU bound work - filtering, sorting, conversions
+        // kept apart from instance(), so waiting on the network does not starve computations and vice versa
+        static QThreadPool* computeInstance();
+
+        // runs given function on instance()
+        // at most targetConcurrency() tasks of given target run at once, interactive tasks are started before background ones
+        template<typename Function>
+        static QFuture<std::invoke_result_t<Function>> run(const QString& target, Priority priority, Function function);
+
+        // returns target identifying given database - for use with run()
+        static QString target(DatabaseType databaseType, const QVariantMap& connectionParameters = {});
+
+        // maximum number of concurrently running tasks of given target - 0 means no limit other than size of the pool
+        static int targetConcurrency(const QString& target);
+        static void setTargetConcurrency(const QString& target, int maxConcurrency);
+
+        // maximum number of concurrently running tasks of targets without own limit - 4 by default
+        static int defaultTargetConcurrency();
+        static void setDefaultTargetConcurrency(int maxConcurrency);
+
+        // returns number of tasks of given target waiting for its concurrency limit
+        static int queueDepth(const QString& target);
+
+        // returns statistics of tasks started through run()
+        static Metrics metrics();
+
+    private:
+        // queues given task
+        static void enqueue(const QString& target, Priority priority, std::function<void()> task);
+    };
+
+    template<typename Function>
+    QFuture<std::invoke_result_t<Function>> SQLThreadPool::run(const QString& target, Priority priority, Function function)
+    {
+        using Result = std::invoke_result_t<Function>;
+
+        auto promise = std::make_shared<QPromise<Result>>();
+        auto future = promise->future();
+
+        enqueue(target, priority, [promise, function = std::move(function)]() mutable {
+            promise->start();
+            if constexpr (std::is_void_v<Result>) {
+                function();
+            } else {
+                promise->addResult(function());
+            }
+            promise->finish();
+        });
+
+        return future;
+    }
+}   // namespace IzSQLUtilities
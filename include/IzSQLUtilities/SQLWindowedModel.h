@@ -0,0 +1,211 @@
+﻿#pragma once
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <QHash>
+#include <QSet>
+
+#include "IzSQLUtilities/AbstractSQLModel.h"
+#include "IzSQLUtilities/IzSQLUtilities_Global.h"
+
+class QTimer;
+
+namespace IzSQLUtilities
+{
+    // read only model of huge results - only a window of the result is held in memory
+    // refresh loads row count (COUNT(*) of the query or rowCountQuery) and the first page, other pages are loaded when data() reads them
+    // pages are fetched by keyset (WHERE key > last key ORDER BY key), least recently used pages over maxCachedPages are evicted
+    // values are available through Qt::DisplayRole and roles of the columns (Qt::UserRole + column)
+    // WARNING: keyColumns have to identify rows uniquely, rows are ordered by them ascending
+    // WARNING: editing, adding rows and data sharing of AbstractSQLModel are not supported, cacheResults and partitioning are ignored
+    class IZSQLUTILITIESSHARED_EXPORT SQLWindowedModel : public AbstractSQLModel
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SQLWindowedModel)
+
+        // columns the result is ordered and paged by - applied by the next refresh
+        Q_PROPERTY(QStringList keyColumns READ keyColumns WRITE setKeyColumns NOTIFY keyColumnsChanged FINAL)
+
+        // number of rows of single page - applied by the next refresh
+        Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged FINAL)
+
+        // number of pages loaded ahead on both sides of the page being read
+        Q_PROPERTY(int prefetchPages READ prefetchPages WRITE setPrefetchPages NOTIFY prefetchPagesChanged FINAL)
+
+        // maximum number of pages held in memory
+        Q_PROPERTY(int maxCachedPages READ maxCachedPages WRITE setMaxCachedPages NOTIFY maxCachedPagesChanged FINAL)
+
+        // query returning number of rows, e.g. estimate from server statistics - COUNT(*) of the query is used if empty
+        // parameters of the model's query are available to it
+        Q_PROPERTY(QString rowCountQuery READ rowCountQuery WRITE setRowCountQuery NOTIFY rowCountQueryChanged FINAL)
+
+    public:
+        // ctor
+        explicit SQLWindowedModel(QObject* parent = nullptr);
+
+        // dtor
+        ~SQLWindowedModel() = default;
+
+        // QAbstractItemModel interface start
+
+        int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+        bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+
+        // QAbstractItemModel interface end
+
+        // AbstractSQLModel interface start
+
+        // rows can not be added nor removed - always return false
+        bool addRow(const QVariantMap& data, bool defaultInitialize = false, const QStringList& uniqueColumnValues = {}) override;
+        bool removeRow(int index) override;
+
+        // AbstractSQLModel interface end
+
+        // returns true if row with given index is held in memory
+        Q_INVOKABLE bool isRowLoaded(int row) const;
+
+        // m_keyColumns getter / setter
+        QStringList keyColumns() const;
+        void setKeyColumns(const QStringList& keyColumns);
+
+        // m_pageSize getter / setter
+        int pageSize() const;
+        void setPageSize(int pageSize);
+
+        // m_prefetchPages getter / setter
+        int prefetchPages() const;
+        void setPrefetchPages(int prefetchPages);
+
+        // m_maxCachedPages getter / setter
+        int maxCachedPages() const;
+        void setMaxCachedPages(int maxCachedPages);
+
+        // m_rowCountQuery getter / setter
+        QString rowCountQuery() const;
+        void setRowCountQuery(const QString& rowCountQuery);
+
+    protected:
+        // AbstractSQLModel interface start
+
+        void additionalDataParsing(bool dataRefreshSucceeded) override;
+        QFuture<LoadedData> startFullRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters) override;
+        bool holdsAllRows() const override;
+
+        // AbstractSQLModel interface end
+
+    private:
+        // rows of single page
+        struct Page {
+            // rows of the page
+            std::vector<std::shared_ptr<SQLRow>> rows;
+
+            // position of the page in m_recentPages
+            std::list<int>::iterator recent;
+        };
+
+        // paging state of loaded result - set by refresh
+        struct Window {
+            // query the result was loaded with
+            QString sqlQuery;
+
+            // parameters of the query
+            QVariantMap sqlParameters;
+
+            // columns the result is paged by
+            QStringList keyColumns;
+
+            // number of rows of single page
+            int pageSize{ 0 };
+
+            // number of rows of the result
+            int rowCount{ 0 };
+
+            // rows of the first page
+            std::vector<std::shared_ptr<SQLRow>> firstPage;
+        };
+
+        // columns the result is ordered and paged by
+        QStringList m_keyColumns;
+
+        // number of rows of single page
+        int m_pageSize{ 256 };
+
+        // number of pages loaded ahead on both sides of the page being read
+        int m_prefetchPages{ 1 };
+
+        // maximum number of pages held in memory
+        int m_maxCachedPages{ 64 };
+
+        // query returning number of rows
+        QString m_rowCountQuery;
+
+        // paging state of current data
+        Window m_window;
+
+        // paging state loaded by running refresh - applied by additionalDataParsing()
+        Window m_loadedWindow;
+
+        // pages held in memory
+        mutable QHash<int, Page> m_pages;
+
+        // pages held in memory, most recently read first
+        mutable std::list<int> m_recentPages;
+
+        // pages being loaded or waiting for retry - pages which failed too many times stay here until the next refresh
+        mutable QSet<int> m_loadingPages;
+
+        // page -> number of its failed loads since the last refresh
+        QHash<int, int> m_pageFailures;
+
+        // first page past the end of the result or -1 if not known yet - rowCountQuery can overestimate row count
+        int m_endPage{ -1 };
+
+        // pages requested since the last load
+        mutable QList<int> m_requestedPages;
+
+        // collects requests of single event loop turn into one load
+        QTimer* m_pageLoadTimer;
+
+        // key values of the first and last rows of pages loaded so far - pages next to them are loaded by keyset
+        QHash<int, QVariantList> m_firstKeys;
+        QHash<int, QVariantList> m_lastKeys;
+
+        // page read by the last data() call
+        mutable int m_lastReadPage{ -1 };
+
+        // incremented whenever data is replaced - pages of older data are dropped
+        quint64 m_windowGeneration{ 0 };
+
+        // task of full refresh - loads row count and the first page
+        LoadedData loadWindow(const QString& sqlQuery, const QVariantMap& sqlParameters);
+
+        // returns row with given index or nullptr if its page is not loaded - requests the page
+        SQLRow* row(int index) const;
+
+        // requests load of given page, if it is not loaded nor being loaded
+        void requestPage(int page) const;
+
+        // loads requested pages
+        void loadRequestedPages();
+
+        // inserts loaded page, evicting least recently used ones
+        void insertPage(int page, std::vector<std::shared_ptr<SQLRow>> rows);
+
+        // removes rows past given row count once the end of the result is found - rowCountQuery can overestimate it
+        void trimWindow(int rowCount);
+
+        // records key values of the first and last row of given page
+        void storePageKeys(int page, const std::vector<std::shared_ptr<SQLRow>>& rows);
+
+    signals:
+        // Q_PROPERTY *Changed signals
+        void keyColumnsChanged();
+        void pageSizeChanged();
+        void prefetchPagesChanged();
+        void maxCachedPagesChanged();
+        void rowCountQueryChanged();
+    };
+}   // namespace IzSQLUtilities
@@ -1,27 +1,279 @@
 ﻿#include "IzSQLUtilities/AbstractSQLModel.h"
 
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+#include <QPromise>
+#include <QSemaphore>
+#include <QSqlDriver>
+#include <QSqlField>
 #include <QSqlQuery>
 #include <QSqlRecord>
+#include <QTimer>
 #include <QtConcurrent>
 
 #include "IzSQLUtilities/SQLConnector.h"
 #include "IzSQLUtilities/SQLErrorEvent.h"
+#include "IzSQLUtilities/SQLResultCache.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
 
 #include "LoadedSQLData.h"
+#include "SQLColumnStore.h"
+#include "SQLColumnType.h"
+#include "SQLQueryTemplate.h"
+#include "SQLRingBuffer.h"
+#include "SQLSchema.h"
+#include "SQLSnapshot.h"
+
+namespace
+{
+    // number of rows passed at once between stages of pipelined load
+    constexpr std::size_t pipelineBatchRows{ 256 };
+
+    // number of batches queued between stages of pipelined load
+    constexpr std::size_t pipelineCapacity{ 8 };
+
+    // number of rows which pending cells are fetched with single query
+    constexpr int deferredBatchRows{ 100 };
+
+    // returns true if given field holds blobs or long texts
+    bool isLargeColumn(const QSqlField& field, IzSQLUtilities::DatabaseType databaseType)
+    {
+        if (field.metaType().id() == QMetaType::QByteArray) {
+            return true;
+        }
+
+        // MSSQL reports (n)varchar(max) columns with unknown length
+        return field.metaType().id() == QMetaType::QString && (field.length() > 4000 || (field.length() < 0 && databaseType == IzSQLUtilities::DatabaseType::MSSQL));
+    }
+
+    // returns key of the row with given key values
+    QString deferredRowKey(const QVariantList& keyValues)
+    {
+        QStringList parts;
+        for (const auto& value : keyValues) {
+            parts.append(value.toString());
+        }
+
+        return parts.join(QLatin1Char('\x1f'));
+    }
+
+    // selects values of given column for rows with given key values, result is keyed with deferredRowKey()
+    QHash<QString, QVariant> selectDeferredValues(IzSQLUtilities::DatabaseType databaseType, const QVariantMap& connectionParameters, const QString& sqlQuery, const QVariantMap& sqlParameters, const QStringList& keyColumns, const QString& column, const QList<QVariantList>& keys)
+    {
+        QHash<QString, QVariant> values;
+
+        IzSQLUtilities::SqlConnector db(databaseType, connectionParameters);
+        if (!db.getConnection().isOpen()) {
+            IzSQLUtilities::SQLErrorEvent::postSQLError(db.lastError());
+            return values;
+        }
+
+        const QSqlDriver* driver = db.getConnection().driver();
+        const auto escaped = [driver](const QString& name) {
+            return driver->escapeIdentifier(name, QSqlDriver::FieldName);
+        };
+
+        QStringList selected;
+        for (const auto& keyColumn : keyColumns) {
+            selected.append(escaped(keyColumn));
+        }
+        selected.append(escaped(column));
+
+        QVariantMap parameters = sqlParameters;
+        QStringList rowConditions;
+        for (int row = 0; row < keys.size(); ++row) {
+            QStringList keyConditions;
+            for (int key = 0; key < keyColumns.size(); ++key) {
+                const QString parameter = QStringLiteral(":izKey%1_%2").arg(row).arg(key);
+                keyConditions.append(QStringLiteral("%1 = %2").arg(escaped(keyColumns.at(key)), parameter));
+                parameters.insert(parameter, keys.at(row).at(key));
+            }
+            rowConditions.append(QStringLiteral("(%1)").arg(keyConditions.join(QStringLiteral(" AND "))));
+        }
+
+        QSqlQuery query(db.getConnection());
+        query.setForwardOnly(true);
+        query.prepare(QStringLiteral("SELECT %1 FROM (%2) izDeferred WHERE %3").arg(selected.join(QStringLiteral(", ")), IzSQLUtilities::SQLQueryTemplate::wrappable(sqlQuery), rowConditions.join(QStringLiteral(" OR "))));
+
+        QMapIterator<QString, QVariant> it(parameters);
+        while (it.hasNext()) {
+            it.next();
+            query.bindValue(it.key(), it.value());
+        }
+
+        if (!query.exec()) {
+            qWarning() << query.lastError();
+            IzSQLUtilities::SQLErrorEvent::postSQLError(query.lastError());
+            return values;
+        }
+
+        const int keyCount = static_cast<int>(keyColumns.size());
+        while (query.next()) {
+            QVariantList keyValues;
+            for (int i = 0; i < keyCount; ++i) {
+                keyValues.append(query.value(i));
+            }
+            values.insert(deferredRowKey(keyValues), query.value(keyCount));
+        }
+
+        return values;
+    }
+
+    // splits 'column [ASC|DESC]' into column name and direction - returns false on entry in other format
+    bool parseOrderColumn(const QString& orderColumn, QString& column, bool& descending)
+    {
+        const QStringList parts = orderColumn.simplified().split(QLatin1Char(' '));
+        if (parts.first().isEmpty() || parts.size() > 2) {
+            return false;
+        }
+
+        column = parts.first();
+        descending = false;
+
+        if (parts.size() == 2) {
+            if (parts.at(1).compare(QStringLiteral("DESC"), Qt::CaseInsensitive) == 0) {
+                descending = true;
+            } else if (parts.at(1).compare(QStringLiteral("ASC"), Qt::CaseInsensitive) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // k-way merges rows of partitions sorted by given (column, descending) pairs into rows
+    // WARNING: strings are compared with QString::compare() - merged order of columns with non binary collation can slightly differ from the server's one
+    void mergePartitions(std::vector<std::shared_ptr<IzSQLUtilities::LoadedSQLData>>& partitions, const std::vector<std::pair<int, bool>>& orderBy, bool nullsLast, std::vector<std::shared_ptr<IzSQLUtilities::SQLRow>>& rows)
+    {
+        // returns true if left row goes before right row
+        const auto before = [&orderBy, nullsLast](const IzSQLUtilities::SQLRow& left, const IzSQLUtilities::SQLRow& right) {
+            for (const auto& [column, descending] : orderBy) {
+                const QVariant leftValue = left.columnValue(column);
+                const QVariant rightValue = right.columnValue(column);
+
+                // nulls follow server's default - last in ascending order on PSQL, first elsewhere
+                int order{ 0 };
+                if (leftValue.isNull() || rightValue.isNull()) {
+                    order = leftValue.isNull() == rightValue.isNull() ? 0 : (leftValue.isNull() != nullsLast ? -1 : 1);
+                } else {
+                    const auto comparison = QVariant::compare(leftValue, rightValue);
+                    order = comparison == QPartialOrdering::Less ? -1 : (comparison == QPartialOrdering::Greater ? 1 : 0);
+                }
+
+                if (order != 0) {
+                    return descending ? order > 0 : order < 0;
+                }
+            }
+
+            return false;
+        };
+
+        // heads of partitions - partition index, position in partition
+        std::vector<std::pair<std::size_t, std::size_t>> heads;
+        const auto after = [&partitions, &before](const std::pair<std::size_t, std::size_t>& left, const std::pair<std::size_t, std::size_t>& right) {
+            const auto& leftRow = *partitions[left.first]->sqlData()[left.second];
+            const auto& rightRow = *partitions[right.first]->sqlData()[right.second];
+
+            // equal rows keep order of partitions
+            return before(rightRow, leftRow) || (!before(leftRow, rightRow) && left.first > right.first);
+        };
+
+        for (std::size_t i = 0; i < partitions.size(); ++i) {
+            if (!partitions[i]->sqlData().empty()) {
+                heads.emplace_back(i, 0);
+            }
+        }
+        std::make_heap(heads.begin(), heads.end(), after);
+
+        while (!heads.empty()) {
+            std::pop_heap(heads.begin(), heads.end(), after);
+            auto& head = heads.back();
+            auto& partitionRows = partitions[head.first]->sqlData();
+
+            rows.push_back(std::move(partitionRows[head.second]));
+            head.second++;
+
+            if (head.second < partitionRows.size()) {
+                std::push_heap(heads.begin(), heads.end(), after);
+            } else {
+                heads.pop_back();
+            }
+        }
+    }
+}   // namespace
 
 IzSQLUtilities::AbstractSQLModel::AbstractSQLModel(QObject* parent)
     : IzModels::AbstractItemModel(parent)
+    , m_schema(SQLSchema::empty())
+    , m_queryTemplate(SQLQueryTemplate::empty())
     , m_refreshFutureWatcher(new QFutureWatcher<LoadedData>(this))
+    , m_deferredFetchTimer(new QTimer(this))
 {
     // watchers setup
     connect(m_refreshFutureWatcher, &QFutureWatcher<LoadedData>::finished, this, &AbstractSQLModel::parseSQLData);
+
+    // deferred cells setup
+    m_deferredFetchTimer->setSingleShot(true);
+    m_deferredFetchTimer->setInterval(0);
+    connect(m_deferredFetchTimer, &QTimer::timeout, this, &AbstractSQLModel::fetchDeferredValues);
 }
 
+struct IzSQLUtilities::AbstractSQLModel::Projection {
+    // record of the unprojected query
+    QSqlRecord record;
+
+    // record indexes of fetched columns, in order of projected query - empty if query is not projected
+    std::vector<int> fetchedColumns;
+
+    // record indexes of deferred columns
+    std::vector<int> pendingColumns;
+};
+
+struct IzSQLUtilities::AbstractSQLModel::PartitionedLoad {
+    // unprojected query and its parameters
+    QString sqlQuery;
+    QVariantMap sqlParameters;
+
+    // query partitions are cut from - projected one if some columns are deferred
+    QString projectedQuery;
+
+    // database target partitions are queued on
+    QString target;
+
+    // layout key of partitions' results
+    QString schemaKey;
+
+    // number of partitions
+    int partitions{ 0 };
+
+    Projection projection;
+    FetchProgress progress;
+
+    // results of partitions, in order of partitions
+    std::vector<LoadedData> results;
+
+    // partitions which did not finish yet
+    std::atomic<int> pendingPartitions{ 0 };
+
+    // result of the whole refresh
+    QPromise<LoadedData> promise;
+
+    // reports result of the whole refresh
+    void finish(LoadedData loadedData)
+    {
+        promise.addResult(std::move(loadedData));
+        promise.finish();
+    }
+};
+
 QVariant IzSQLUtilities::AbstractSQLModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     Q_UNUSED(role)
     if (orientation == Qt::Horizontal) {
-        return m_columnNameColumnAliasMap.contains(columnNameFromIndex(section)) ? m_columnNameColumnAliasMap[columnNameFromIndex(section)] : m_indexColumnMap[section];
+        return m_columnNameColumnAliasMap.contains(columnNameFromIndex(section)) ? m_columnNameColumnAliasMap[columnNameFromIndex(section)] : m_schema->indexColumnMap().value(section);
     }
 
     return section;
@@ -65,325 +317,1307 @@ int IzSQLUtilities::AbstractSQLModel::rowCount(const QModelIndex& parent) const
 int IzSQLUtilities::AbstractSQLModel::columnCount(const QModelIndex& parent) const
 {
     Q_UNUSED(parent)
-    return m_indexColumnMap.size();
+    return m_schema->columnCount();
+}
+
+bool IzSQLUtilities::AbstractSQLModel::hasChildren(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent)
+    return {};
+}
+
+bool IzSQLUtilities::AbstractSQLModel::canFetchMore(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent)
+    return false;
+}
+
+void IzSQLUtilities::AbstractSQLModel::fetchMore(const QModelIndex& parent)
+{
+    Q_UNUSED(parent)
+}
+
+QString IzSQLUtilities::AbstractSQLModel::columnNameFromIndex(int index) const
+{
+    return m_schema->indexColumnMap().value(index);
+}
+
+int IzSQLUtilities::AbstractSQLModel::indexFromColumnName(const QString& column) const
+{
+    // WARNING: tu nastąpiły bardzo podejrzane zmiany
+    if (m_columnAliasColumnNameMap.contains(column)) {
+        return m_schema->columnIndexMap().value(m_columnAliasColumnNameMap.value(column).toString(), -1);
+    }
+
+    return m_schema->columnIndexMap().value(column, -1);
+}
+
+bool IzSQLUtilities::AbstractSQLModel::validateSqlQuery(const SQLQueryTemplate& queryTemplate, const QVariantMap& sqlParameters, bool silent)
+{
+    bool res{ true };
+
+    for (const auto& parameter : queryTemplate.parameters()) {
+        if (!sqlParameters.contains(parameter)) {
+            if (!silent) {
+                qCritical() << "Parameter" << parameter << "not found in passed parameters.";
+            }
+            res = false;
+        }
+    }
+
+    if (queryTemplate.unterminatedDelimiter() != -1) {
+        if (!silent) {
+            qCritical() << "Unterminated delimiter. Delimiter start position:" << queryTemplate.unterminatedDelimiter();
+        }
+        res = false;
+    }
+
+    if (queryTemplate.parameters().size() != sqlParameters.size()) {
+        if (!silent) {
+            qCritical() << "Number of parameters in query are not equal to passed parameters.";
+        }
+        res = false;
+    }
+
+    if (m_queryIsValid != res) {
+        m_queryIsValid = res;
+        emit queryIsValidChanged();
+    }
+
+    if (res) {
+        emit validQuerySet();
+    }
+
+    return res;
+}
+
+bool IzSQLUtilities::AbstractSQLModel::queryIsValid() const
+{
+    return m_queryIsValid;
+}
+
+QVariantMap IzSQLUtilities::AbstractSQLModel::columnNameColumnAliasMap() const
+{
+    return m_columnNameColumnAliasMap;
+}
+
+void IzSQLUtilities::AbstractSQLModel::setColumnNameColumnAliasMap(const QVariantMap& columnNameColumnAliasMap)
+{
+    m_columnNameColumnAliasMap = columnNameColumnAliasMap;
+    m_columnAliasColumnNameMap.clear();
+
+    QMapIterator<QString, QVariant> it(m_columnNameColumnAliasMap);
+    while (it.hasNext()) {
+        it.next();
+        m_columnAliasColumnNameMap.insert(it.value().toString(), it.key());
+    }
+}
+
+QMetaType IzSQLUtilities::AbstractSQLModel::columnDataType(int index) const
+{
+    if (index >= 0 && static_cast<std::size_t>(index) < m_schema->dataTypes().size()) {
+        return m_schema->dataTypes()[static_cast<std::size_t>(index)];
+    }
+
+    return QMetaType{};
+}
+
+int IzSQLUtilities::AbstractSQLModel::roleNameToColumn(const QString& roleName)
+{
+    return m_schema->columnIndexMap().value(roleName, -1);
+}
+
+const std::vector<std::shared_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::AbstractSQLModel::internalData() const
+{
+    return m_data;
+}
+
+const QMap<int, QString>& IzSQLUtilities::AbstractSQLModel::indexColumnMap() const
+{
+    return m_schema->indexColumnMap();
+}
+
+const QHash<QString, int>& IzSQLUtilities::AbstractSQLModel::columnIndexMap() const
+{
+    return m_schema->columnIndexMap();
+}
+
+bool IzSQLUtilities::AbstractSQLModel::schemaChanged() const
+{
+    return m_schemaChanged;
+}
+
+bool IzSQLUtilities::AbstractSQLModel::abortRequested() const
+{
+    return m_abortRequested;
+}
+
+IzSQLUtilities::SQLRow& IzSQLUtilities::AbstractSQLModel::detachRow(int index)
+{
+    auto& row = m_data[static_cast<std::size_t>(index)];
+    if (row.use_count() > 1) {
+        row = std::make_shared<SQLRow>(*row);
+    }
+
+    return *row;
+}
+
+void IzSQLUtilities::AbstractSQLModel::detachRows()
+{
+    for (int i = 0; i < static_cast<int>(m_data.size()); ++i) {
+        detachRow(i);
+    }
+}
+
+bool IzSQLUtilities::AbstractSQLModel::insertDefaultRows(int row, int count)
+{
+    if (row < 0 || row > rowCount() || count <= 0 || columnCount() == 0) {
+        qCritical() << "Cannot insert" << count << "rows at:" << row;
+        return false;
+    }
+
+    std::vector<std::shared_ptr<SQLRow>> rows;
+    rows.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        auto sqlRow = std::make_shared<SQLRow>(static_cast<std::size_t>(columnCount()));
+        for (int column = 0; column < columnCount(); ++column) {
+            sqlRow->addColumnValue(QVariant(columnDataType(column)));
+        }
+        rows.push_back(std::move(sqlRow));
+    }
+
+    beginInsertRows({}, row, row + count - 1);
+    m_data.insert(m_data.begin() + row, std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+    endInsertRows();
+
+    return true;
+}
+
+void IzSQLUtilities::AbstractSQLModel::additionalDataParsing(bool dataRefreshSucceeded)
+{
+    Q_UNUSED(dataRefreshSucceeded)
+}
+
+QStringList IzSQLUtilities::AbstractSQLModel::rowKeyColumns() const
+{
+    return {};
+}
+
+bool IzSQLUtilities::AbstractSQLModel::holdsAllRows() const
+{
+    return true;
+}
+
+void IzSQLUtilities::AbstractSQLModel::requestDeferredValue(int row, int column) const
+{
+    const quint64 cell = (static_cast<quint64>(row) << 32) | static_cast<quint32>(column);
+    if (m_requestedDeferredCells.contains(cell)) {
+        return;
+    }
+
+    m_requestedDeferredCells.insert(cell);
+    m_deferredRequests[column].append(row);
+    m_deferredFetchTimer->start();
+}
+
+void IzSQLUtilities::AbstractSQLModel::deferredValuesFetched(int column, const QList<int>& rows)
+{
+    for (const int row : rows) {
+        emit dataChanged(index(row, column), index(row, column));
+    }
+}
+
+void IzSQLUtilities::AbstractSQLModel::fetchDeferredValues()
+{
+    const auto requests = std::exchange(m_deferredRequests, {});
+    if (m_deferredKeyColumns.isEmpty()) {
+        return;
+    }
+
+    // key columns are resolved once - schema does not change until data is replaced
+    QList<int> keyIndexes;
+    for (const auto& keyColumn : std::as_const(m_deferredKeyColumns)) {
+        keyIndexes.append(m_schema->columnIndexMap().value(keyColumn, -1));
+    }
+
+    const auto target = SQLThreadPool::target(m_databaseType, m_connectionParameters);
+    const quint64 generation = m_dataGeneration;
+
+    for (auto it = requests.cbegin(); it != requests.cend(); ++it) {
+        const int column = it.key();
+        const QString columnName = m_schema->indexColumnMap().value(column);
+
+        for (qsizetype first = 0; first < it.value().size(); first += deferredBatchRows) {
+            const QList<int> rows = it.value().mid(first, deferredBatchRows);
+
+            QList<QVariantList> keys;
+            for (const int row : rows) {
+                QVariantList keyValues;
+                for (const int keyIndex : std::as_const(keyIndexes)) {
+                    keyValues.append(m_data[static_cast<std::size_t>(row)]->columnValue(keyIndex));
+                }
+                keys.append(keyValues);
+            }
+
+            SQLThreadPool::run(target, SQLThreadPool::Priority::Interactive, [databaseType = m_databaseType, connectionParameters = m_connectionParameters, query = m_deferredQuery, parameters = m_deferredParameters, keyColumns = m_deferredKeyColumns, columnName, keys]() {
+                return selectDeferredValues(databaseType, connectionParameters, query, parameters, keyColumns, columnName, keys);
+            }).then(this, [this, generation, column, rows, keys](const QHash<QString, QVariant>& values) {
+                // data was replaced in the meantime
+                if (generation != m_dataGeneration) {
+                    return;
+                }
+
+                QList<int> fetchedRows;
+                for (int i = 0; i < rows.size(); ++i) {
+                    const int row = rows.at(i);
+                    m_requestedDeferredCells.remove((static_cast<quint64>(row) << 32) | static_cast<quint32>(column));
+
+                    // rows could have been moved or removed since the request
+                    if (static_cast<std::size_t>(row) >= m_data.size()) {
+                        continue;
+                    }
+
+                    QVariantList keyValues;
+                    for (const auto& keyColumn : std::as_const(m_deferredKeyColumns)) {
+                        keyValues.append(m_data[static_cast<std::size_t>(row)]->columnValue(m_schema->columnIndexMap().value(keyColumn, -1)));
+                    }
+
+                    if (keyValues != keys.at(i)) {
+                        continue;
+                    }
+
+                    m_data[static_cast<std::size_t>(row)]->setFetchedValue(column, values.value(deferredRowKey(keyValues)));
+                    fetchedRows.append(row);
+                }
+
+                if (!fetchedRows.isEmpty()) {
+                    deferredValuesFetched(column, fetchedRows);
+                }
+            });
+        }
+    }
 }
 
-bool IzSQLUtilities::AbstractSQLModel::hasChildren(const QModelIndex& parent) const
-{
-    Q_UNUSED(parent)
-    return {};
+void IzSQLUtilities::AbstractSQLModel::resetDeferredValues()
+{
+    m_deferredFetchTimer->stop();
+    m_deferredRequests.clear();
+    m_requestedDeferredCells.clear();
+    m_dataGeneration++;
+}
+
+std::vector<std::shared_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::AbstractSQLModel::internalData()
+{
+    detachRows();
+    return m_data;
+}
+
+void IzSQLUtilities::AbstractSQLModel::parseSQLData()
+{
+    // result is moved out of the future - no copies of loaded data or its layout
+    applyRefreshResult(m_refreshFutureWatcher->future().takeResult());
+}
+
+void IzSQLUtilities::AbstractSQLModel::applyRefreshResult(const LoadedData& loadedData)
+{
+    const auto refreshResult = std::get<0>(loadedData);
+
+    if (refreshResult == AbstractSQLModel::DataRefreshResult::Refreshed) {
+        applyLoadedData(*std::get<2>(loadedData));
+
+        emit dataRefreshEnded(true);
+    } else if (refreshResult == AbstractSQLModel::DataRefreshResult::Aborted) {
+        // aborted refresh keeps current data
+        emit dataRefreshEnded(false);
+    } else {
+        beginResetModel();
+
+        m_data.clear();
+        m_schema = SQLSchema::empty();
+        m_schemaChanged = true;
+        resetDeferredValues();
+        m_pendingColumns.clear();
+
+        additionalDataParsing(false);
+        endResetModel();
+
+        emit dataRefreshEnded(false);
+    }
+}
+
+void IzSQLUtilities::AbstractSQLModel::beginGroupRefresh()
+{
+    emit aboutToRefreshData();
+
+    // group refresh uses the latest query and parameters - scheduled one is no longer needed
+    cancelScheduledRefresh();
+
+    m_abortRequested = false;
+    emit dataRefreshStarted();
+}
+
+void IzSQLUtilities::AbstractSQLModel::applyLoadedData(LoadedSQLData& sqlData)
+{
+    beginResetModel();
+
+    m_data.swap(sqlData.sqlData());
+    m_schemaChanged = (m_schema != sqlData.schema());
+    m_schema = sqlData.schema();
+
+    resetDeferredValues();
+    m_deferredQuery = sqlData.deferredSource().sqlQuery;
+    m_deferredParameters = sqlData.deferredSource().sqlParameters;
+    m_deferredKeyColumns = sqlData.deferredSource().keyColumns;
+    m_pendingColumns = sqlData.deferredSource().pendingColumns;
+
+    additionalDataParsing(true);
+    endResetModel();
+}
+
+QFuture<IzSQLUtilities::AbstractSQLModel::LoadedData> IzSQLUtilities::AbstractSQLModel::startFullRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    return m_cacheResults ? startCachedRefresh(sqlQuery, sqlParameters) : startUncachedRefresh(sqlQuery, sqlParameters);
+}
+
+QFuture<IzSQLUtilities::AbstractSQLModel::LoadedData> IzSQLUtilities::AbstractSQLModel::startUncachedRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    if (isPartitioned(sqlQuery)) {
+        return startPartitionedRefresh(sqlQuery, sqlParameters);
+    }
+
+    if (!m_partitionColumn.isEmpty() && SQLQueryTemplate::hasOrderBy(sqlQuery)) {
+        qWarning() << "Query has ORDER BY - it is loaded without partitions, use partitionOrderBy instead.";
+    }
+
+    return SQLThreadPool::run(SQLThreadPool::target(m_databaseType, m_connectionParameters), SQLThreadPool::Priority::Interactive, [this, sqlQuery, sqlParameters]() -> LoadedData {
+        return fullDataRefresh(sqlQuery, sqlParameters);
+    });
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::fetchQuery(const QSqlDatabase& database, const QString& sqlQuery, const QVariantMap& sqlParameters, const QString& schemaKey, const Projection& projection, FetchProgress& progress)
+{
+    // qsql query setup
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(sqlQuery);
+
+    QMapIterator<QString, QVariant> it(sqlParameters);
+    while (it.hasNext()) {
+        it.next();
+        query.bindValue(it.key(), it.value());
+    }
+
+    // query exec
+    if (!query.exec()) {
+        qWarning() << query.lastError();
+        SQLErrorEvent::postSQLError(query.lastError());
+        return { AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    return fetchResult(query, schemaKey, projection, progress);
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::fetchResult(QSqlQuery& query, const QString& schemaKey, const Projection& projection, FetchProgress& progress)
+{
+    if (--progress.pendingQueries == 0) {
+        emit sqlQueryReturned();
+    }
+
+    if (m_abortRequested) {
+        return { AbstractSQLModel::DataRefreshResult::Aborted, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    // projected query fetches only part of the columns - rows keep layout of the unprojected one
+    const std::vector<int>& fetchedColumns = projection.fetchedColumns;
+    const QSqlRecord record = fetchedColumns.empty() ? query.record() : projection.record;
+    const std::vector<int>& pendingColumns = projection.pendingColumns;
+
+    // declared column types - cells are coerced once, during conversion
+    std::vector<std::optional<SQLColumnType>> columnTypes(static_cast<std::size_t>(record.count()));
+    QHash<QString, QMetaType> declaredTypes;
+    for (int i = 0; i < record.count(); ++i) {
+        const auto declaration = m_columnTypes.constFind(record.fieldName(i));
+        if (declaration != m_columnTypes.cend()) {
+            auto& columnType = columnTypes[static_cast<std::size_t>(i)];
+            columnType = SQLColumnType::parse(declaration.value().toString());
+            if (columnType) {
+                declaredTypes.insert(record.fieldName(i), columnType->metaType());
+            }
+        }
+    }
+
+    // additional data - layout of repeated query is reused as long as it does not change
+    int rowCount = 0;
+    const auto schema = SQLSchema::fromRecord(schemaKey, record, declaredTypes);
+    const int columnsCount = schema->columnCount();
+
+    auto sqlData = std::make_shared<LoadedSQLData>();
+    sqlData->setSchema(schema);
+
+    // raw values storage for lazy decoding
+    std::shared_ptr<SQLColumnStore> columnStore;
+    if (m_lazyDecoding) {
+        columnStore = std::make_shared<SQLColumnStore>(schema->dataTypes());
+    }
+
+    // conversion of fetched values into rows
+    std::size_t convertedRows{ 0 };
+    const auto convertRow = [&](const QVariant* values) {
+        const auto cell = [&](int column) -> QVariant {
+            const auto& columnType = columnTypes[static_cast<std::size_t>(column)];
+            return columnType ? columnType->coerce(values[column]) : values[column];
+        };
+
+        std::shared_ptr<SQLRow> row;
+        if (columnStore) {
+            for (int i = 0; i < columnsCount; ++i) {
+                columnStore->append(i, cell(i));
+            }
+
+            row = std::make_shared<SQLRow>(static_cast<std::size_t>(columnsCount), columnStore, convertedRows);
+        } else {
+            row = std::make_shared<SQLRow>(static_cast<std::size_t>(columnsCount));
+            for (int i = 0; i < columnsCount; ++i) {
+                row->addColumnValue(cell(i));
+            }
+        }
+
+        if (!pendingColumns.empty()) {
+            row->setPending(pendingColumns);
+        }
+
+        sqlData->addRow(std::move(row));
+
+        convertedRows++;
+    };
+
+    // pipelined conversion runs on the compute pool, fed with batches of fetched values
+    // if no compute thread is free right now rows are converted in place - waiting for one could deadlock busy pools
+    const std::size_t batchValues = pipelineBatchRows * static_cast<std::size_t>(columnsCount);
+    SQLRingBuffer<std::vector<QVariant>> batches(pipelineCapacity);
+    QSemaphore conversionFinished;
+
+    const bool pipelined = m_pipelinedLoading && columnsCount > 0 && SQLThreadPool::computeInstance()->tryStart([&]() {
+        std::vector<QVariant> batch;
+        while (batches.pop(batch)) {
+            for (std::size_t i = 0; i < batch.size(); i += static_cast<std::size_t>(columnsCount)) {
+                convertRow(batch.data() + i);
+            }
+        }
+
+        if (columnStore) {
+            columnStore->squeeze();
+        }
+
+        conversionFinished.release();
+    });
+
+    // query data
+    std::vector<QVariant> values;
+    values.reserve(pipelined ? batchValues : static_cast<std::size_t>(columnsCount));
+
+    bool aborted{ false };
+    while (query.next()) {
+        if (m_abortRequested) {
+            aborted = true;
+            break;
+        }
+
+        if (fetchedColumns.empty()) {
+            for (int i = 0; i < columnsCount; ++i) {
+                values.push_back(query.value(i));
+            }
+        } else {
+            const std::size_t base = values.size();
+            values.resize(base + static_cast<std::size_t>(columnsCount));
+            for (std::size_t i = 0; i < fetchedColumns.size(); ++i) {
+                values[base + static_cast<std::size_t>(fetchedColumns[i])] = query.value(static_cast<int>(i));
+            }
+        }
+
+        if (!pipelined) {
+            convertRow(values.data());
+            values.clear();
+        } else if (values.size() >= batchValues) {
+            batches.push(std::move(values));
+            values = {};
+            values.reserve(batchValues);
+        }
+
+        rowCount++;
+        if (rowCount % 100 == 0) {
+            emit rowsLoaded(progress.loadedRows += 100);
+        }
+    }
+
+    // conversion stage references local state - it has to finish even if the load was aborted
+    if (pipelined) {
+        if (!values.empty()) {
+            batches.push(std::move(values));
+        }
+        batches.close();
+        conversionFinished.acquire();
+    } else if (columnStore && !aborted) {
+        columnStore->squeeze();
+    }
+
+    if (aborted) {
+        return { AbstractSQLModel::DataRefreshResult::Aborted, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    emit rowsLoaded(progress.loadedRows += rowCount % 100);
+
+    return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, sqlData };
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::fullDataRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    emit rowsLoaded(0);
+    emit sqlQueryStarted();
+
+    // database connect
+    SqlConnector db(m_databaseType, m_connectionParameters);
+    if (!db.getConnection().isOpen()) {
+        SQLErrorEvent::postSQLError(db.lastError());
+        return { AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    return loadData(db.getConnection(), sqlQuery, sqlParameters);
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::loadData(const QSqlDatabase& database, const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    FetchProgress progress;
+
+    QString query = sqlQuery;
+    Projection projection;
+    const auto projectionResult = projectQuery(database, query, sqlParameters, {}, projection);
+    if (projectionResult != AbstractSQLModel::DataRefreshResult::Refreshed) {
+        return { projectionResult, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    auto loadedData = fetchQuery(database, query, sqlParameters, SQLThreadPool::target(m_databaseType, m_connectionParameters) + QLatin1Char('\x1e') + sqlQuery, projection, progress);
+    if (std::get<0>(loadedData) != AbstractSQLModel::DataRefreshResult::Refreshed) {
+        return loadedData;
+    }
+
+    if (!projection.fetchedColumns.empty()) {
+        std::get<2>(loadedData)->setDeferredSource({ sqlQuery, sqlParameters, rowKeyColumns(), projection.pendingColumns });
+    }
+
+    finishDataLoad(sqlQuery, *std::get<2>(loadedData));
+
+    return loadedData;
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::loadResult(QSqlQuery& query, const QString& resultKey)
+{
+    FetchProgress progress;
+
+    emit rowsLoaded(0);
+
+    auto loadedData = fetchResult(query, resultKey, Projection(), progress);
+    if (std::get<0>(loadedData) != AbstractSQLModel::DataRefreshResult::Refreshed) {
+        return loadedData;
+    }
+
+    finishDataLoad(resultKey, *std::get<2>(loadedData));
+
+    return loadedData;
+}
+
+void IzSQLUtilities::AbstractSQLModel::finishDataLoad(const QString& sqlQuery, const LoadedSQLData& sqlData)
+{
+    m_newQuery = (m_lastQuery != sqlQuery);
+    m_lastQuery = sqlQuery;
+
+    if (m_autoSaveSnapshot && !m_snapshotPath.isEmpty()) {
+        // pending cells would be saved as nulls
+        if (!sqlData.deferredSource().pendingColumns.empty()) {
+            qWarning() << "Snapshot was not saved - data has deferred columns.";
+            return;
+        }
+
+        SQLSnapshot::save(m_snapshotPath, sqlData.sqlData(), sqlData.schema()->indexColumnMap(), sqlData.schema()->dataTypes());
+    }
+}
+
+bool IzSQLUtilities::AbstractSQLModel::defersColumns() const
+{
+    return !m_deferredColumns.isEmpty() || m_deferLargeColumns;
+}
+
+bool IzSQLUtilities::AbstractSQLModel::isPartitioned(const QString& sqlQuery) const
+{
+    if (m_partitionColumn.isEmpty() || (m_partitionBounds.isEmpty() && m_partitionCount <= 1)) {
+        return false;
+    }
+
+    // ordered query can not be wrapped on MSSQL and its order is lost by merging partitions
+    return !SQLQueryTemplate::hasOrderBy(sqlQuery);
+}
+
+IzSQLUtilities::AbstractSQLModel::DataRefreshResult IzSQLUtilities::AbstractSQLModel::projectQuery(const QSqlDatabase& database, QString& sqlQuery, const QVariantMap& sqlParameters, const QStringList& requiredColumns, Projection& projection)
+{
+    if (!defersColumns()) {
+        return AbstractSQLModel::DataRefreshResult::Refreshed;
+    }
+
+    const QStringList keyColumns = rowKeyColumns();
+    if (keyColumns.isEmpty()) {
+        qWarning() << "Model has no key columns - all columns will be loaded.";
+        return AbstractSQLModel::DataRefreshResult::Refreshed;
+    }
+
+    // ordered query can not be wrapped on MSSQL and loses its order elsewhere
+    if (SQLQueryTemplate::hasOrderBy(sqlQuery)) {
+        qWarning() << "Query has ORDER BY - all columns will be loaded.";
+        return AbstractSQLModel::DataRefreshResult::Refreshed;
+    }
+
+    const QString query = SQLQueryTemplate::wrappable(sqlQuery);
+
+    // columns of the query are probed without fetching any rows
+    {
+        QSqlQuery probe(database);
+        probe.setForwardOnly(true);
+        probe.prepare(QStringLiteral("SELECT * FROM (%1) izProjection WHERE 1 = 0").arg(query));
+
+        QMapIterator<QString, QVariant> it(sqlParameters);
+        while (it.hasNext()) {
+            it.next();
+            probe.bindValue(it.key(), it.value());
+        }
+
+        if (!probe.exec()) {
+            qWarning() << probe.lastError();
+            SQLErrorEvent::postSQLError(probe.lastError());
+            return AbstractSQLModel::DataRefreshResult::QueryError;
+        }
+
+        projection.record = probe.record();
+    }
+
+    for (const auto& keyColumn : keyColumns) {
+        if (projection.record.indexOf(keyColumn) == -1) {
+            qWarning() << "Key column" << keyColumn << "not found in the result - all columns will be loaded.";
+            return AbstractSQLModel::DataRefreshResult::Refreshed;
+        }
+    }
+
+    QStringList fetchedNames;
+    std::vector<int> fetchedColumns;
+    std::vector<int> pendingColumns;
+    for (int i = 0; i < projection.record.count(); ++i) {
+        const QSqlField field = projection.record.field(i);
+        const bool deferred = !keyColumns.contains(field.name()) && !requiredColumns.contains(field.name())
+                              && (m_deferredColumns.contains(field.name()) || (m_deferLargeColumns && isLargeColumn(field, m_databaseType)));
+
+        if (deferred) {
+            pendingColumns.push_back(i);
+        } else {
+            fetchedNames.append(database.driver()->escapeIdentifier(field.name(), QSqlDriver::FieldName));
+            fetchedColumns.push_back(i);
+        }
+    }
+
+    // nothing to defer
+    if (pendingColumns.empty()) {
+        return AbstractSQLModel::DataRefreshResult::Refreshed;
+    }
+
+    projection.fetchedColumns = std::move(fetchedColumns);
+    projection.pendingColumns = std::move(pendingColumns);
+    sqlQuery = QStringLiteral("SELECT %1 FROM (%2) izProjection").arg(fetchedNames.join(QStringLiteral(", ")), query);
+
+    return AbstractSQLModel::DataRefreshResult::Refreshed;
+}
+
+QString IzSQLUtilities::AbstractSQLModel::partitionQuery(const QSqlDriver* driver, const QString& sqlQuery, int partition, QVariantMap& sqlParameters) const
+{
+    QString query = SQLQueryTemplate::wrappable(sqlQuery);
+    const QString partitionColumn = driver->escapeIdentifier(m_partitionColumn, QSqlDriver::FieldName);
+
+    QString predicate;
+    if (m_partitionBounds.isEmpty()) {
+        predicate = QStringLiteral("ABS(%1 % %2) = %3").arg(partitionColumn).arg(m_partitionCount).arg(partition);
+    } else {
+        QStringList conditions;
+        if (partition > 0) {
+            conditions.append(QStringLiteral("%1 >= :izPartitionLower").arg(partitionColumn));
+            sqlParameters.insert(QStringLiteral(":izPartitionLower"), m_partitionBounds.at(partition - 1));
+        }
+        if (partition < m_partitionBounds.size()) {
+            conditions.append(QStringLiteral("%1 < :izPartitionUpper").arg(partitionColumn));
+            sqlParameters.insert(QStringLiteral(":izPartitionUpper"), m_partitionBounds.at(partition));
+        }
+        predicate = conditions.join(QStringLiteral(" AND "));
+    }
+
+    // nulls belong to the first partition
+    if (partition == 0) {
+        predicate = QStringLiteral("(%1 OR %2 IS NULL)").arg(predicate, partitionColumn);
+    }
+
+    // order entries were validated before partitions were queued
+    QStringList orderBy;
+    for (const auto& orderColumn : m_partitionOrderBy) {
+        QString column;
+        bool descending{ false };
+        if (parseOrderColumn(orderColumn, column, descending)) {
+            orderBy.append(driver->escapeIdentifier(column, QSqlDriver::FieldName) + (descending ? QStringLiteral(" DESC") : QStringLiteral(" ASC")));
+        }
+    }
+
+    query = QStringLiteral("SELECT * FROM (%1) izPartition WHERE %2").arg(query, predicate);
+    if (!orderBy.isEmpty()) {
+        query += QStringLiteral(" ORDER BY ") + orderBy.join(QStringLiteral(", "));
+    }
+
+    return query;
+}
+
+QFuture<IzSQLUtilities::AbstractSQLModel::LoadedData> IzSQLUtilities::AbstractSQLModel::startPartitionedRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    auto load = std::make_shared<PartitionedLoad>();
+    load->sqlQuery = sqlQuery;
+    load->sqlParameters = sqlParameters;
+    load->projectedQuery = sqlQuery;
+    load->target = SQLThreadPool::target(m_databaseType, m_connectionParameters);
+    load->schemaKey = load->target + QLatin1Char('\x1e') + sqlQuery;
+    load->partitions = m_partitionBounds.isEmpty() ? m_partitionCount : static_cast<int>(m_partitionBounds.size()) + 1;
+    load->results.resize(static_cast<std::size_t>(load->partitions));
+    load->pendingPartitions = load->partitions;
+    load->progress.pendingQueries = load->partitions;
+
+    load->promise.start();
+    auto future = load->promise.future();
+
+    // projection needs a connection - partitions are queued once it is resolved
+    SQLThreadPool::run(load->target, SQLThreadPool::Priority::Interactive, [this, load]() {
+        startPartitions(load);
+    });
+
+    return future;
+}
+
+void IzSQLUtilities::AbstractSQLModel::startPartitions(const std::shared_ptr<PartitionedLoad>& load)
+{
+    emit rowsLoaded(0);
+    emit sqlQueryStarted();
+
+    // columns partitions are split and ordered by are never deferred
+    QStringList requiredColumns{ m_partitionColumn };
+    for (const auto& orderColumn : m_partitionOrderBy) {
+        QString column;
+        bool descending{ false };
+        if (!parseOrderColumn(orderColumn, column, descending)) {
+            qWarning() << "Got invalid partition order:" << orderColumn;
+            load->finish({ AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            return;
+        }
+
+        requiredColumns.append(column);
+    }
+
+    // projection is resolved once for all partitions
+    if (defersColumns()) {
+        SqlConnector db(m_databaseType, m_connectionParameters);
+        if (!db.getConnection().isOpen()) {
+            SQLErrorEvent::postSQLError(db.lastError());
+            load->finish({ AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            return;
+        }
+
+        const auto projectionResult = projectQuery(db.getConnection(), load->projectedQuery, load->sqlParameters, requiredColumns, load->projection);
+        if (projectionResult != AbstractSQLModel::DataRefreshResult::Refreshed) {
+            load->finish({ projectionResult, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            return;
+        }
+    }
+
+    // every partition is fetched on its own connection, as many at once as target's concurrency allows
+    for (int i = 0; i < load->partitions; ++i) {
+        SQLThreadPool::run(load->target, SQLThreadPool::Priority::Interactive, [this, load, i]() {
+            loadPartition(load, i);
+        });
+    }
+}
+
+void IzSQLUtilities::AbstractSQLModel::loadPartition(const std::shared_ptr<PartitionedLoad>& load, int partition)
+{
+    LoadedData loadedData{ AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    {
+        SqlConnector db(m_databaseType, m_connectionParameters);
+        if (db.getConnection().isOpen()) {
+            QVariantMap parameters = load->sqlParameters;
+            const QString query = partitionQuery(db.getConnection().driver(), load->projectedQuery, partition, parameters);
+
+            loadedData = fetchQuery(db.getConnection(), query, parameters, load->schemaKey, load->projection, load->progress);
+        } else {
+            SQLErrorEvent::postSQLError(db.lastError());
+        }
+    }
+
+    // failed partition stops the other ones
+    if (std::get<0>(loadedData) != AbstractSQLModel::DataRefreshResult::Refreshed) {
+        m_abortRequested = true;
+    }
+
+    load->results[static_cast<std::size_t>(partition)] = std::move(loadedData);
+
+    // the last partition hands merge over to compute pool - database target's slot is not held by it
+    if (--load->pendingPartitions == 0) {
+        QtConcurrent::run(SQLThreadPool::computeInstance(), [this, load]() {
+            load->finish(mergePartitionedLoad(*load));
+        });
+    }
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::mergePartitionedLoad(PartitionedLoad& load)
+{
+    const QString& sqlQuery = load.sqlQuery;
+
+    // error of failed partition takes precedence over aborts it caused
+    auto refreshResult = AbstractSQLModel::DataRefreshResult::Refreshed;
+    std::vector<std::shared_ptr<LoadedSQLData>> partitionData;
+    for (const auto& loadedData : load.results) {
+        const auto partitionResult = std::get<0>(loadedData);
+
+        if (partitionResult == AbstractSQLModel::DataRefreshResult::Refreshed) {
+            partitionData.push_back(std::get<2>(loadedData));
+        } else if (refreshResult == AbstractSQLModel::DataRefreshResult::Refreshed || refreshResult == AbstractSQLModel::DataRefreshResult::Aborted) {
+            refreshResult = partitionResult;
+        }
+    }
+    load.results.clear();
+
+    if (refreshResult != AbstractSQLModel::DataRefreshResult::Refreshed) {
+        return { refreshResult, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    auto sqlData = std::make_shared<LoadedSQLData>();
+    sqlData->setSchema(partitionData.front()->schema());
+    if (!load.projection.fetchedColumns.empty()) {
+        sqlData->setDeferredSource({ sqlQuery, load.sqlParameters, rowKeyColumns(), load.projection.pendingColumns });
+    }
+
+    std::size_t rowCount{ 0 };
+    for (const auto& data : partitionData) {
+        rowCount += data->sqlData().size();
+    }
+    sqlData->sqlData().reserve(rowCount);
+
+    // resolve columns of ORDER BY
+    std::vector<std::pair<int, bool>> orderBy;
+    for (const auto& orderColumn : m_partitionOrderBy) {
+        QString columnName;
+        bool descending{ false };
+        parseOrderColumn(orderColumn, columnName, descending);
+
+        const int column = sqlData->schema()->columnIndexMap().value(columnName, -1);
+        if (column == -1) {
+            qWarning() << "Partition order column" << columnName << "not found in the result - partitions will not be merged.";
+            orderBy.clear();
+            break;
+        }
+
+        orderBy.emplace_back(column, descending);
+    }
+
+    if (orderBy.empty()) {
+        for (auto& data : partitionData) {
+            std::move(data->sqlData().begin(), data->sqlData().end(), std::back_inserter(sqlData->sqlData()));
+        }
+    } else {
+        mergePartitions(partitionData, orderBy, m_databaseType == DatabaseType::PSQL, sqlData->sqlData());
+    }
+
+    finishDataLoad(sqlQuery, *sqlData);
+
+    return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, sqlData };
+}
+
+QFuture<IzSQLUtilities::AbstractSQLModel::LoadedData> IzSQLUtilities::AbstractSQLModel::startCachedRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    // own load, if the cache started one - its error is reported instead of the generic one
+    auto ownLoad = std::make_shared<std::optional<QFuture<LoadedData>>>();
+
+    auto cachedLoad = SQLResultCache::fetch(resultCacheKey(sqlQuery, sqlParameters), [this, sqlQuery, sqlParameters, ownLoad]() {
+        *ownLoad = startUncachedRefresh(sqlQuery, sqlParameters);
+        return (*ownLoad)->then([](const LoadedData& loadedData) -> std::shared_ptr<LoadedSQLData> {
+            return std::get<0>(loadedData) == AbstractSQLModel::DataRefreshResult::Refreshed ? std::get<2>(loadedData) : nullptr;
+        });
+    });
+
+    return cachedLoad.then([this, sqlQuery, ownLoad](const std::shared_ptr<const LoadedSQLData>& cachedData) -> LoadedData {
+        // failed load - ours or the one we were served
+        if (!cachedData) {
+            if (ownLoad->has_value() && (*ownLoad)->resultCount() > 0) {
+                return (*ownLoad)->result();
+            }
+
+            return { AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+        }
+
+        // rows of cached data are shared copy-on-write with other models
+        if (!ownLoad->has_value()) {
+            emit rowsLoaded(static_cast<int>(cachedData->sqlData().size()));
+
+            m_newQuery = (m_lastQuery != sqlQuery);
+            m_lastQuery = sqlQuery;
+        }
+
+        return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, std::make_shared<LoadedSQLData>(*cachedData) };
+    });
+}
+
+QString IzSQLUtilities::AbstractSQLModel::resultCacheKey(const QString& sqlQuery, const QVariantMap& sqlParameters) const
+{
+    // deferred cells are not loaded - models deferring different columns cannot share results
+    QVariantMap loadOptions = m_columnTypes;
+    if (defersColumns()) {
+        loadOptions.insert(QStringLiteral("#deferredColumns"), m_deferredColumns.join(QLatin1Char(',')));
+        loadOptions.insert(QStringLiteral("#deferLargeColumns"), m_deferLargeColumns);
+        loadOptions.insert(QStringLiteral("#rowKeyColumns"), rowKeyColumns().join(QLatin1Char(',')));
+    }
+
+    // merged partitions are ordered by partitionOrderBy only - models partitioning differently cannot share results
+    if (isPartitioned(sqlQuery)) {
+        QStringList partitionBounds;
+        for (const auto& bound : m_partitionBounds) {
+            partitionBounds.append(bound.toString());
+        }
+
+        loadOptions.insert(QStringLiteral("#partitionColumn"), m_partitionColumn);
+        loadOptions.insert(QStringLiteral("#partitionCount"), m_partitionBounds.isEmpty() ? m_partitionCount : 0);
+        loadOptions.insert(QStringLiteral("#partitionBounds"), partitionBounds.join(QLatin1Char(',')));
+        loadOptions.insert(QStringLiteral("#partitionOrderBy"), m_partitionOrderBy.join(QLatin1Char(',')));
+    }
+
+    return SQLResultCache::key(sqlQuery, sqlParameters, m_databaseType, m_connectionParameters, loadOptions);
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::partialDataRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters, const QList<int>& rows)
+{
+    Q_UNUSED(sqlQuery)
+    Q_UNUSED(sqlParameters)
+    Q_UNUSED(rows)
+
+    qDebug() << "implement me :[";
+    return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+}
+
+QString IzSQLUtilities::AbstractSQLModel::databaseName() const
+{
+    return m_databaseName;
+}
+
+void IzSQLUtilities::AbstractSQLModel::setDatabaseName(const QString& databaseName)
+{
+    if (databaseName == QStringLiteral("MSSQL")) {
+        setDatabaseType(IzSQLUtilities::DatabaseType::MSSQL);
+    } else if (databaseName == QStringLiteral("PSQL")) {
+        setDatabaseType(IzSQLUtilities::DatabaseType::PSQL);
+    } else if (databaseName == QStringLiteral("SQLITE")) {
+        setDatabaseType(IzSQLUtilities::DatabaseType::SQLITE);
+    } else {
+        qWarning() << "Got invalid database name:" << databaseName;
+    }
+}
+
+IzSQLUtilities::DatabaseType IzSQLUtilities::AbstractSQLModel::databaseType() const
+{
+    return m_databaseType;
+}
+
+void IzSQLUtilities::AbstractSQLModel::setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType)
+{
+    if (m_databaseType != databaseType) {
+        m_databaseType = databaseType;
+
+        switch (m_databaseType) {
+        case DatabaseType::MSSQL:
+            m_databaseName = QStringLiteral("MSSQL");
+            break;
+        case DatabaseType::SQLITE:
+            m_databaseName = QStringLiteral("SQLITE");
+            break;
+        case DatabaseType::PSQL:
+            m_databaseName = QStringLiteral("PSQL");
+            break;
+        }
+
+        emit databaseTypeChanged();
+    }
 }
 
-bool IzSQLUtilities::AbstractSQLModel::canFetchMore(const QModelIndex& parent) const
+QString IzSQLUtilities::AbstractSQLModel::snapshotPath() const
 {
-    Q_UNUSED(parent)
-    return false;
+    return m_snapshotPath;
 }
 
-void IzSQLUtilities::AbstractSQLModel::fetchMore(const QModelIndex& parent)
+void IzSQLUtilities::AbstractSQLModel::setSnapshotPath(const QString& snapshotPath)
 {
-    Q_UNUSED(parent)
+    if (m_snapshotPath != snapshotPath) {
+        m_snapshotPath = snapshotPath;
+        emit snapshotPathChanged();
+    }
 }
 
-QString IzSQLUtilities::AbstractSQLModel::columnNameFromIndex(int index) const
+bool IzSQLUtilities::AbstractSQLModel::autoSaveSnapshot() const
 {
-    return m_indexColumnMap.value(index);
+    return m_autoSaveSnapshot;
 }
 
-int IzSQLUtilities::AbstractSQLModel::indexFromColumnName(const QString& column) const
+void IzSQLUtilities::AbstractSQLModel::setAutoSaveSnapshot(bool autoSaveSnapshot)
 {
-    // WARNING: tu nastąpiły bardzo podejrzane zmiany
-    if (m_columnAliasColumnNameMap.contains(column)) {
-        return m_columnIndexMap.value(m_columnAliasColumnNameMap.value(column).toString(), -1);
+    if (m_autoSaveSnapshot != autoSaveSnapshot) {
+        m_autoSaveSnapshot = autoSaveSnapshot;
+        emit autoSaveSnapshotChanged();
     }
-
-    return m_columnIndexMap.value(column, -1);
 }
 
-bool IzSQLUtilities::AbstractSQLModel::validateSqlQuery(const QString& sqlQuery, const QVariantMap& sqlParameters, bool silent)
+bool IzSQLUtilities::AbstractSQLModel::loadSnapshot()
 {
-    bool res{ true };
-    const int queryStringSize = sqlQuery.size();
-    int delimiterStart{ -1 };
-    int delimiterEnd{ -1 };
-    int parametersFound{ 0 };
-
-    for (auto i = 0; i < queryStringSize; ++i) {
-        if (sqlQuery[i] == QStringLiteral("'") && i < queryStringSize - 1 && sqlQuery[i + 1] == QStringLiteral(":")) {
-            delimiterStart = i;
-        } else if (delimiterStart != -1 && sqlQuery[i] == QStringLiteral("'")) {
-            delimiterEnd = i;
-        }
-        if (delimiterStart != -1 && delimiterEnd != -1) {
-            auto str = sqlQuery.mid(delimiterStart + 1, delimiterEnd - delimiterStart - 1);
-            if (!sqlParameters.contains(str)) {
-                if (!silent) {
-                    qCritical() << "Parameter" << str << "not found in passed parameters.";
-                }
-                res = false;
-            }
-            parametersFound++;
-            delimiterStart = -1;
-            delimiterEnd = -1;
-        }
+    if (isRefreshingData()) {
+        qCritical() << "Snapshot load is not possible - model is still loading data.";
+        return false;
     }
 
-    if (delimiterStart != -1 && delimiterEnd == -1) {
-        if (!silent) {
-            qCritical() << "Unterminated delimiter. Delimiter start position:" << delimiterStart;
-        }
-        res = false;
+    if (m_snapshotPath.isEmpty()) {
+        qCritical() << "Snapshot load is not possible - snapshot path was not set.";
+        return false;
     }
 
-    if (parametersFound != sqlParameters.size()) {
-        if (!silent) {
-            qCritical() << "Number of parameters in query are not equal to passed parameters.";
-        }
-        res = false;
+    auto sqlData = SQLSnapshot::load(m_snapshotPath);
+    if (!sqlData) {
+        return false;
     }
 
-    if (m_queryIsValid != res) {
-        m_queryIsValid = res;
-        emit queryIsValidChanged();
+    applyLoadedData(*sqlData);
+    emit snapshotLoaded();
+
+    return true;
+}
+
+bool IzSQLUtilities::AbstractSQLModel::saveSnapshot()
+{
+    if (m_snapshotPath.isEmpty()) {
+        qCritical() << "Snapshot save is not possible - snapshot path was not set.";
+        return false;
     }
 
-    if (res) {
-        emit validQuerySet();
+    if (hasDeferredColumns()) {
+        qCritical() << "Snapshot save is not possible - data has deferred columns.";
+        return false;
     }
 
-    return res;
+    return SQLSnapshot::save(m_snapshotPath, m_data, m_schema->indexColumnMap(), m_schema->dataTypes());
 }
 
-QString IzSQLUtilities::AbstractSQLModel::normalizeSqlQuery(const QString& sqlQuery, const QVariantMap& sqlParameters) const
+bool IzSQLUtilities::AbstractSQLModel::cacheResults() const
 {
-    QString tmp = sqlQuery;
-    QMapIterator<QString, QVariant> it(sqlParameters);
-    while (it.hasNext()) {
-        it.next();
-        tmp.replace(QStringLiteral("'") + it.key() + QStringLiteral("'"), it.key());
-    }
-
-    return tmp;
+    return m_cacheResults;
 }
 
-bool IzSQLUtilities::AbstractSQLModel::queryIsValid() const
+void IzSQLUtilities::AbstractSQLModel::setCacheResults(bool cacheResults)
 {
-    return m_queryIsValid;
+    if (m_cacheResults != cacheResults) {
+        m_cacheResults = cacheResults;
+        emit cacheResultsChanged();
+    }
 }
 
-QVariantMap IzSQLUtilities::AbstractSQLModel::columnNameColumnAliasMap() const
+void IzSQLUtilities::AbstractSQLModel::invalidateCachedResult()
 {
-    return m_columnNameColumnAliasMap;
+    SQLResultCache::remove(resultCacheKey(m_queryTemplate->normalizedQuery(m_sqlQueryParameters), m_sqlQueryParameters));
 }
 
-void IzSQLUtilities::AbstractSQLModel::setColumnNameColumnAliasMap(const QVariantMap& columnNameColumnAliasMap)
+bool IzSQLUtilities::AbstractSQLModel::shareDataFrom(AbstractSQLModel* other)
 {
-    m_columnNameColumnAliasMap = columnNameColumnAliasMap;
-    m_columnAliasColumnNameMap.clear();
+    if (other == nullptr || other == this) {
+        qCritical() << "Got invalid model to share data from.";
+        return false;
+    }
 
-    QMapIterator<QString, QVariant> it(m_columnNameColumnAliasMap);
-    while (it.hasNext()) {
-        it.next();
-        m_columnAliasColumnNameMap.insert(it.value().toString(), it.key());
+    if (isRefreshingData() || other->isRefreshingData()) {
+        qCritical() << "Data sharing is not possible - model is still loading data.";
+        return false;
     }
-}
 
-QMetaType IzSQLUtilities::AbstractSQLModel::columnDataType(int index) const
-{
-    if (index >= 0 && static_cast<std::size_t>(index) < m_sqlDataTypes.size()) {
-        return m_sqlDataTypes[static_cast<std::size_t>(index)];
+    if (!holdsAllRows() || !other->holdsAllRows()) {
+        qCritical() << "Data sharing is not possible - model loads its rows on demand.";
+        return false;
     }
 
-    return QMetaType{};
-}
+    emit dataRefreshStarted();
 
-int IzSQLUtilities::AbstractSQLModel::roleNameToColumn(const QString& roleName)
-{
-    return m_columnIndexMap.value(roleName, -1);
+    LoadedSQLData sqlData;
+    sqlData.sqlData() = other->m_data;
+    sqlData.setSchema(other->m_schema);
+    sqlData.setDeferredSource({ other->m_deferredQuery, other->m_deferredParameters, other->m_deferredKeyColumns, other->m_pendingColumns });
+    applyLoadedData(sqlData);
+
+    emit dataRefreshEnded(true);
+
+    return true;
 }
 
-const std::vector<std::unique_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::AbstractSQLModel::internalData() const
+bool IzSQLUtilities::AbstractSQLModel::lazyDecoding() const
 {
-    return m_data;
+    return m_lazyDecoding;
 }
 
-const QMap<int, QString>& IzSQLUtilities::AbstractSQLModel::indexColumnMap() const
+void IzSQLUtilities::AbstractSQLModel::setLazyDecoding(bool lazyDecoding)
 {
-    return m_indexColumnMap;
+    if (m_lazyDecoding != lazyDecoding) {
+        m_lazyDecoding = lazyDecoding;
+        emit lazyDecodingChanged();
+    }
 }
 
-const QHash<QString, int>& IzSQLUtilities::AbstractSQLModel::columnIndexMap() const
+bool IzSQLUtilities::AbstractSQLModel::pipelinedLoading() const
 {
-    return m_columnIndexMap;
+    return m_pipelinedLoading;
 }
 
-void IzSQLUtilities::AbstractSQLModel::additionalDataParsing(bool dataRefreshSucceeded)
+void IzSQLUtilities::AbstractSQLModel::setPipelinedLoading(bool pipelinedLoading)
 {
-    Q_UNUSED(dataRefreshSucceeded)
+    if (m_pipelinedLoading != pipelinedLoading) {
+        m_pipelinedLoading = pipelinedLoading;
+        emit pipelinedLoadingChanged();
+    }
 }
 
-std::vector<std::unique_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::AbstractSQLModel::internalData()
+QVariantMap IzSQLUtilities::AbstractSQLModel::columnTypes() const
 {
-    return m_data;
+    return m_columnTypes;
 }
 
-void IzSQLUtilities::AbstractSQLModel::parseSQLData()
+void IzSQLUtilities::AbstractSQLModel::setColumnTypes(const QVariantMap& columnTypes)
 {
-    if (std::get<0>(m_refreshFutureWatcher->result()) == AbstractSQLModel::DataRefreshResult::Refreshed) {
-        beginResetModel();
-
-        m_data.swap(std::get<2>(m_refreshFutureWatcher->result())->sqlData());
-        m_sqlDataTypes.swap(std::get<2>(m_refreshFutureWatcher->result())->sqlDataTypes());
-        m_columnIndexMap = std::get<2>(m_refreshFutureWatcher->result())->columnIndexMap();
-        m_indexColumnMap = std::get<2>(m_refreshFutureWatcher->result())->indexColumnMap();
-
-        additionalDataParsing(true);
-        endResetModel();
-
-        emit dataRefreshEnded(true);
-    } else {
-        beginResetModel();
-
-        m_data.clear();
-        m_sqlDataTypes.clear();
-        m_columnIndexMap.clear();
-        m_indexColumnMap.clear();
-
-        additionalDataParsing(false);
-        endResetModel();
+    if (m_columnTypes != columnTypes) {
+        QMapIterator<QString, QVariant> it(columnTypes);
+        while (it.hasNext()) {
+            it.next();
+            if (!SQLColumnType::parse(it.value().toString())) {
+                qWarning() << "Got invalid type declaration" << it.value().toString() << "for column" << it.key() << "- column will be loaded as is.";
+            }
+        }
 
-        emit dataRefreshEnded(false);
+        m_columnTypes = columnTypes;
+        emit columnTypesChanged();
     }
 }
 
-IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::fullDataRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+QStringList IzSQLUtilities::AbstractSQLModel::deferredColumns() const
 {
-    // database connect
-    SqlConnector db(m_databaseType, m_connectionParameters);
-    if (!db.getConnection().isOpen()) {
-        SQLErrorEvent::postSQLError(db.lastError());
-        return { AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
-    }
-
-    // qsql query setup
-    QSqlQuery query(db.getConnection());
-    query.setForwardOnly(true);
-    query.prepare(sqlQuery);
+    return m_deferredColumns;
+}
 
-    QMapIterator<QString, QVariant> it(sqlParameters);
-    while (it.hasNext()) {
-        it.next();
-        query.bindValue(it.key(), it.value());
+void IzSQLUtilities::AbstractSQLModel::setDeferredColumns(const QStringList& deferredColumns)
+{
+    if (m_deferredColumns != deferredColumns) {
+        m_deferredColumns = deferredColumns;
+        emit deferredColumnsChanged();
     }
+}
 
-    emit rowsLoaded(0);
+bool IzSQLUtilities::AbstractSQLModel::deferLargeColumns() const
+{
+    return m_deferLargeColumns;
+}
 
-    // query exec
-    emit sqlQueryStarted();
-    if (!query.exec()) {
-        qWarning() << query.lastError();
-        SQLErrorEvent::postSQLError(query.lastError());
-        return { AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+void IzSQLUtilities::AbstractSQLModel::setDeferLargeColumns(bool deferLargeColumns)
+{
+    if (m_deferLargeColumns != deferLargeColumns) {
+        m_deferLargeColumns = deferLargeColumns;
+        emit deferLargeColumnsChanged();
     }
-    emit sqlQueryReturned();
-
-    m_newQuery = (m_lastQuery != query.lastQuery());
-    m_lastQuery = query.lastQuery();
-
-    // additional data
-    int rowCount = 0;
-    int columnsCount = query.record().count();
-
-    QHash<QString, int> columnIndexMap;
-    columnIndexMap.reserve(columnsCount);
-
-    QMap<int, QString> indexColumnMap;
+}
 
-    std::vector<QMetaType> dataTypes;
-    dataTypes.reserve(static_cast<std::size_t>(columnsCount));
+bool IzSQLUtilities::AbstractSQLModel::autoRefresh() const
+{
+    return m_autoRefresh;
+}
 
-    for (int i = 0; i < columnsCount; i++) {
-        dataTypes.emplace_back(query.record().value(i).metaType());
-        columnIndexMap.insert(query.record().fieldName(i), i);
-        indexColumnMap.insert(i, query.record().fieldName(i));
+void IzSQLUtilities::AbstractSQLModel::setAutoRefresh(bool autoRefresh)
+{
+    if (m_autoRefresh != autoRefresh) {
+        m_autoRefresh = autoRefresh;
+        emit autoRefreshChanged();
     }
+}
 
-    auto sqlData = std::make_shared<LoadedSQLData>();
-
-    sqlData->setSqlDataTypes(dataTypes);
-    sqlData->setColumnIndexMap(columnIndexMap);
-    sqlData->setIndexColumnMap(indexColumnMap);
+IzSQLUtilities::SQLRefreshScheduler* IzSQLUtilities::AbstractSQLModel::refreshScheduler() const
+{
+    return m_refreshScheduler;
+}
 
-    // query data
-    while (query.next()) {
-        if (rowCount % 100 == 0) {
-            emit rowsLoaded(rowCount);
-        }
+void IzSQLUtilities::AbstractSQLModel::setRefreshScheduler(SQLRefreshScheduler* refreshScheduler)
+{
+    if (m_refreshScheduler != refreshScheduler) {
+        cancelScheduledRefresh();
+        m_refreshScheduler = refreshScheduler;
+        emit refreshSchedulerChanged();
+    }
+}
 
-        auto row = std::make_unique<SQLRow>(static_cast<std::size_t>(columnsCount));
-        for (int i = 0; i < columnsCount; ++i) {
-            row->addColumnValue(query.value(i));
-        }
+QString IzSQLUtilities::AbstractSQLModel::partitionColumn() const
+{
+    return m_partitionColumn;
+}
 
-        sqlData->addRow(std::move(row));
-        rowCount++;
+void IzSQLUtilities::AbstractSQLModel::setPartitionColumn(const QString& partitionColumn)
+{
+    if (m_partitionColumn != partitionColumn) {
+        m_partitionColumn = partitionColumn;
+        emit partitionColumnChanged();
     }
-    emit rowsLoaded(rowCount);
+}
 
-    return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, sqlData };
+int IzSQLUtilities::AbstractSQLModel::partitionCount() const
+{
+    return m_partitionCount;
 }
 
-IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::AbstractSQLModel::partialDataRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters, const QList<int>& rows)
+void IzSQLUtilities::AbstractSQLModel::setPartitionCount(int partitionCount)
 {
-    Q_UNUSED(sqlQuery)
-    Q_UNUSED(sqlParameters)
-    Q_UNUSED(rows)
+    if (partitionCount < 1) {
+        qWarning() << "Got invalid partition count:" << partitionCount;
+        return;
+    }
 
-    qDebug() << "implement me :[";
-    return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    if (m_partitionCount != partitionCount) {
+        m_partitionCount = partitionCount;
+        emit partitionCountChanged();
+    }
 }
 
-QString IzSQLUtilities::AbstractSQLModel::databaseName() const
+QVariantList IzSQLUtilities::AbstractSQLModel::partitionBounds() const
 {
-    return m_databaseName;
+    return m_partitionBounds;
 }
 
-void IzSQLUtilities::AbstractSQLModel::setDatabaseName(const QString& databaseName)
+void IzSQLUtilities::AbstractSQLModel::setPartitionBounds(const QVariantList& partitionBounds)
 {
-    if (databaseName == QStringLiteral("MSSQL")) {
-        setDatabaseType(IzSQLUtilities::DatabaseType::MSSQL);
-    } else if (databaseName == QStringLiteral("PSQL")) {
-        setDatabaseType(IzSQLUtilities::DatabaseType::PSQL);
-    } else if (databaseName == QStringLiteral("SQLITE")) {
-        setDatabaseType(IzSQLUtilities::DatabaseType::SQLITE);
-    } else {
-        qWarning() << "Got invalid database name:" << databaseName;
+    if (m_partitionBounds != partitionBounds) {
+        m_partitionBounds = partitionBounds;
+        emit partitionBoundsChanged();
     }
 }
 
-IzSQLUtilities::DatabaseType IzSQLUtilities::AbstractSQLModel::databaseType() const
+QStringList IzSQLUtilities::AbstractSQLModel::partitionOrderBy() const
 {
-    return m_databaseType;
+    return m_partitionOrderBy;
 }
 
-void IzSQLUtilities::AbstractSQLModel::setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType)
+void IzSQLUtilities::AbstractSQLModel::setPartitionOrderBy(const QStringList& partitionOrderBy)
 {
-    if (m_databaseType != databaseType) {
-        m_databaseType = databaseType;
-
-        switch (m_databaseType) {
-        case DatabaseType::MSSQL:
-            m_databaseName = QStringLiteral("MSSQL");
-            break;
-        case DatabaseType::SQLITE:
-            m_databaseName = QStringLiteral("SQLITE");
-            break;
-        case DatabaseType::PSQL:
-            m_databaseName = QStringLiteral("PSQL");
-            break;
-        }
-
-        emit databaseTypeChanged();
+    if (m_partitionOrderBy != partitionOrderBy) {
+        m_partitionOrderBy = partitionOrderBy;
+        emit partitionOrderByChanged();
     }
 }
 
@@ -397,6 +1631,10 @@ void IzSQLUtilities::AbstractSQLModel::setConnectionParameters(const QVariantMap
     if (m_connectionParameters != connectionParameters) {
         m_connectionParameters = connectionParameters;
         emit connectionParametersChanged();
+
+        if (m_autoRefresh) {
+            scheduleRefresh();
+        }
     }
 }
 
@@ -411,7 +1649,11 @@ void IzSQLUtilities::AbstractSQLModel::setSqlQueryParameters(const QVariantMap&
         m_sqlQueryParameters = sqlQueryParameters;
         emit sqlQueryParametersChanged();
         if (!m_sqlQuery.isEmpty()) {
-            validateSqlQuery(m_sqlQuery, m_sqlQueryParameters, true);
+            validateSqlQuery(*m_queryTemplate, m_sqlQueryParameters, true);
+        }
+
+        if (m_autoRefresh) {
+            scheduleRefresh();
         }
     }
 }
@@ -423,8 +1665,13 @@ void IzSQLUtilities::AbstractSQLModel::clearData()
 
     beginResetModel();
     m_data.clear();
-    m_columnIndexMap.clear();
-    m_indexColumnMap.clear();
+    m_schema = SQLSchema::empty();
+    m_schemaChanged = true;
+    resetDeferredValues();
+    m_deferredQuery.clear();
+    m_deferredParameters.clear();
+    m_deferredKeyColumns.clear();
+    m_pendingColumns.clear();
     endResetModel();
 
     emit dataRefreshEnded(true);
@@ -434,6 +1681,7 @@ void IzSQLUtilities::AbstractSQLModel::clearData()
 void IzSQLUtilities::AbstractSQLModel::clearQueryData()
 {
     m_sqlQuery.clear();
+    m_queryTemplate = SQLQueryTemplate::empty();
     m_sqlQueryParameters.clear();
     m_queryIsValid = false;
     emit queryIsValidChanged();
@@ -448,7 +1696,7 @@ void IzSQLUtilities::AbstractSQLModel::refreshData(const QString& sqlQuery, cons
         return;
     }
 
-    validateSqlQuery(sqlQuery, sqlParameters);
+    validateSqlQuery(*SQLQueryTemplate::compile(sqlQuery), sqlParameters);
     if (!queryIsValid()) {
         qCritical() << "Sql query or its parameters are invalid.";
         return;
@@ -456,16 +1704,17 @@ void IzSQLUtilities::AbstractSQLModel::refreshData(const QString& sqlQuery, cons
     setSqlQuery(sqlQuery);
     setSqlQueryParameters(sqlParameters);
 
+    // running refresh uses the latest query and parameters - scheduled one is no longer needed
+    cancelScheduledRefresh();
+
+    m_abortRequested = false;
     emit dataRefreshStarted();
 
     if (rows.isEmpty()) {
-        QFuture<LoadedData> refreshFuture = QtConcurrent::run([this, query = m_sqlQuery, parameters = m_sqlQueryParameters]() -> LoadedData {
-            return this->fullDataRefresh(normalizeSqlQuery(query, parameters), parameters);
-        });
-        m_refreshFutureWatcher->setFuture(refreshFuture);
+        m_refreshFutureWatcher->setFuture(startFullRefresh(m_queryTemplate->normalizedQuery(m_sqlQueryParameters), m_sqlQueryParameters));
     } else {
-        QFuture<LoadedData> refreshFuture = QtConcurrent::run([this, query = m_sqlQuery, parameters = m_sqlQueryParameters, rows = rows]() -> LoadedData {
-            return this->partialDataRefresh(normalizeSqlQuery(query, parameters), parameters, rows);
+        QFuture<LoadedData> refreshFuture = SQLThreadPool::run(SQLThreadPool::target(m_databaseType, m_connectionParameters), SQLThreadPool::Priority::Interactive, [this, queryTemplate = m_queryTemplate, parameters = m_sqlQueryParameters, rows = rows]() -> LoadedData {
+            return this->partialDataRefresh(queryTemplate->normalizedQuery(parameters), parameters, rows);
         });
         m_refreshFutureWatcher->setFuture(refreshFuture);
     }
@@ -483,12 +1732,46 @@ void IzSQLUtilities::AbstractSQLModel::refreshData()
         return;
     }
 
+    cancelScheduledRefresh();
+
+    m_abortRequested = false;
     emit dataRefreshStarted();
 
-    QFuture<LoadedData> refreshFuture = QtConcurrent::run([this, query = m_sqlQuery, parameters = m_sqlQueryParameters]() -> LoadedData {
-        return this->fullDataRefresh(normalizeSqlQuery(query, parameters), parameters);
-    });
-    m_refreshFutureWatcher->setFuture(refreshFuture);
+    m_refreshFutureWatcher->setFuture(startFullRefresh(m_queryTemplate->normalizedQuery(m_sqlQueryParameters), m_sqlQueryParameters));
+}
+
+void IzSQLUtilities::AbstractSQLModel::scheduleRefresh()
+{
+    activeRefreshScheduler()->schedule(this);
+}
+
+IzSQLUtilities::SQLRefreshScheduler* IzSQLUtilities::AbstractSQLModel::activeRefreshScheduler()
+{
+    if (m_refreshScheduler) {
+        return m_refreshScheduler;
+    }
+
+    if (m_ownRefreshScheduler == nullptr) {
+        m_ownRefreshScheduler = new SQLRefreshScheduler(this);
+    }
+
+    return m_ownRefreshScheduler;
+}
+
+void IzSQLUtilities::AbstractSQLModel::cancelScheduledRefresh()
+{
+    if (m_refreshScheduler) {
+        m_refreshScheduler->cancel(this);
+    } else if (m_ownRefreshScheduler != nullptr) {
+        m_ownRefreshScheduler->cancel(this);
+    }
+}
+
+void IzSQLUtilities::AbstractSQLModel::abortRefresh()
+{
+    if (isRefreshingData()) {
+        m_abortRequested = true;
+    }
 }
 
 QString IzSQLUtilities::AbstractSQLModel::sqlQuery() const
@@ -500,15 +1783,24 @@ void IzSQLUtilities::AbstractSQLModel::setSqlQuery(const QString& sqlQuery)
 {
     if (m_sqlQuery != sqlQuery) {
         m_sqlQuery = sqlQuery;
-        validateSqlQuery(m_sqlQuery, m_sqlQueryParameters, true);
+        m_queryTemplate = SQLQueryTemplate::compile(m_sqlQuery);
+        validateSqlQuery(*m_queryTemplate, m_sqlQueryParameters, true);
         emit sqlQueryChanged();
+
+        if (m_autoRefresh) {
+            scheduleRefresh();
+        }
     }
 }
 
 void IzSQLUtilities::AbstractSQLModel::addQueryParameter(const QString& parameter, const QVariant& value)
 {
     m_sqlQueryParameters.insert(parameter, value);
-    validateSqlQuery(m_sqlQuery, m_sqlQueryParameters, true);
+    validateSqlQuery(*m_queryTemplate, m_sqlQueryParameters, true);
+
+    if (m_autoRefresh) {
+        scheduleRefresh();
+    }
 }
 
 bool IzSQLUtilities::AbstractSQLModel::addRow(const QVariantMap& data, bool defaultInitialize, const QStringList& uniqueColumnValues)
@@ -519,9 +1811,9 @@ bool IzSQLUtilities::AbstractSQLModel::addRow(const QVariantMap& data, bool defa
     //	data uniqueness - if requested
 
     // temporary row
-    auto row = std::make_unique<SQLRow>(columnCount());
+    auto row = std::make_shared<SQLRow>(columnCount());
 
-    QMapIterator<int, QString> it(m_indexColumnMap);
+    QMapIterator<int, QString> it(m_schema->indexColumnMap());
     while (it.hasNext()) {
         it.next();
 
@@ -558,6 +1850,11 @@ bool IzSQLUtilities::AbstractSQLModel::addRow(const QVariantMap& data, bool defa
         QVariantMap valuesToSearchFor;
 
         for (const auto& column : qAsConst(uniqueColumnValues)) {
+            if (isDeferredColumn(indexFromColumnName(column))) {
+                qCritical() << "Cannot add data row - unique column" << column << "is deferred.";
+                return false;
+            }
+
             valuesToSearchFor.insert(column, data.value(column));
         }
 
@@ -599,6 +1896,14 @@ bool IzSQLUtilities::AbstractSQLModel::executedNewQuery() const
 
 int IzSQLUtilities::AbstractSQLModel::findRow(const QVariantMap& columnValues) const
 {
+    // pending cells would be compared as nulls
+    for (auto it = columnValues.cbegin(); it != columnValues.cend(); ++it) {
+        if (isDeferredColumn(indexFromColumnName(it.key()))) {
+            qCritical() << "Cannot search deferred column" << it.key();
+            return -1;
+        }
+    }
+
     auto pos = std::find_if(m_data.begin(), m_data.end(), [this, &columnValues](const auto& row) -> bool {
         int hits{ 0 };
         QMapIterator<QString, QVariant> it(columnValues);
@@ -613,3 +1918,13 @@ int IzSQLUtilities::AbstractSQLModel::findRow(const QVariantMap& columnValues) c
 
     return pos == m_data.end() ? -1 : static_cast<int>(std::distance(m_data.begin(), pos));
 }
+
+bool IzSQLUtilities::AbstractSQLModel::isDeferredColumn(int column) const
+{
+    return std::find(m_pendingColumns.cbegin(), m_pendingColumns.cend(), column) != m_pendingColumns.cend();
+}
+
+bool IzSQLUtilities::AbstractSQLModel::hasDeferredColumns() const
+{
+    return !m_pendingColumns.empty();
+}
@@ -1,41 +1,79 @@
 ﻿#include "LoadedSQLData.h"
 
-QMap<int, QString> IzSQLUtilities::LoadedSQLData::indexColumnMap() const
+#include <QSet>
+
+IzSQLUtilities::LoadedSQLData::LoadedSQLData(const LoadedSQLData& other)
+    : m_sqlData(other.m_sqlData)
+    , m_schema(other.m_schema)
+    , m_deferredSource(other.m_deferredSource)
 {
-    return m_indexColumnMap;
 }
 
-void IzSQLUtilities::LoadedSQLData::setIndexColumnMap(const QMap<int, QString>& indexColumnMap)
+const std::shared_ptr<const IzSQLUtilities::SQLSchema>& IzSQLUtilities::LoadedSQLData::schema() const
 {
-    m_indexColumnMap = indexColumnMap;
+    return m_schema;
 }
 
-void IzSQLUtilities::LoadedSQLData::addRow(std::unique_ptr<SQLRow> row)
+void IzSQLUtilities::LoadedSQLData::setSchema(std::shared_ptr<const SQLSchema> schema)
 {
-    m_sqlData.push_back(std::move(row));
+    m_schema = std::move(schema);
 }
 
-std::vector<QMetaType>& IzSQLUtilities::LoadedSQLData::sqlDataTypes()
+const IzSQLUtilities::LoadedSQLData::DeferredSource& IzSQLUtilities::LoadedSQLData::deferredSource() const
 {
-    return m_sqlDataTypes;
+    return m_deferredSource;
 }
 
-void IzSQLUtilities::LoadedSQLData::setSqlDataTypes(const std::vector<QMetaType>& sqlDataTypes)
+void IzSQLUtilities::LoadedSQLData::setDeferredSource(const DeferredSource& deferredSource)
 {
-    m_sqlDataTypes = sqlDataTypes;
+    m_deferredSource = deferredSource;
 }
 
-QHash<QString, int> IzSQLUtilities::LoadedSQLData::columnIndexMap() const
+void IzSQLUtilities::LoadedSQLData::addRow(std::shared_ptr<SQLRow> row)
 {
-    return m_columnIndexMap;
+    m_sqlData.push_back(std::move(row));
 }
 
-void IzSQLUtilities::LoadedSQLData::setColumnIndexMap(const QHash<QString, int>& columnIndexMap)
+std::vector<std::shared_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::LoadedSQLData::sqlData()
 {
-    m_columnIndexMap = columnIndexMap;
+    return m_sqlData;
 }
 
-std::vector<std::unique_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::LoadedSQLData::sqlData()
+const std::vector<std::shared_ptr<IzSQLUtilities::SQLRow>>& IzSQLUtilities::LoadedSQLData::sqlData() const
 {
     return m_sqlData;
 }
+
+qint64 IzSQLUtilities::LoadedSQLData::estimatedSize() const
+{
+    const int columnCount = m_schema->columnCount();
+    qint64 size = static_cast<qint64>(m_sqlData.size()) * static_cast<qint64>(sizeof(SQLRow) + columnCount * sizeof(QVariant));
+    QSet<const SQLRowSource*> sources;
+
+    for (const auto& row : m_sqlData) {
+        // lazy rows are accounted by their source - decoding them here would defeat the purpose
+        if (row->source() != nullptr) {
+            if (!sources.contains(row->source())) {
+                sources.insert(row->source());
+                size += row->source()->estimatedSize();
+            }
+            continue;
+        }
+
+        for (int i = 0; i < columnCount; ++i) {
+            const QVariant value = row->columnValue(i);
+            switch (value.typeId()) {
+            case QMetaType::QString:
+                size += value.toString().size() * static_cast<qint64>(sizeof(QChar));
+                break;
+            case QMetaType::QByteArray:
+                size += value.toByteArray().size();
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    return size;
+}
@@ -5,51 +5,70 @@
 #include <vector>
 
 #include <QHash>
+#include <QStringList>
 #include <QVariant>
 
 #include "IzSQLUtilities/SQLRow.h"
 
+#include "SQLSchema.h"
+
 namespace IzSQLUtilities
 {
     class LoadedSQLData
     {
     public:
+        // source of cells not fetched during load - set only for projected loads
+        struct DeferredSource {
+            // query the data was loaded with, without projection
+            QString sqlQuery;
+
+            // parameters of the query
+            QVariantMap sqlParameters;
+
+            // columns identifying rows
+            QStringList keyColumns;
+
+            // indexes of columns not fetched during load
+            std::vector<int> pendingColumns;
+        };
+
         // ctor
         LoadedSQLData() = default;
 
+        // copy ctor - rows are shared, models detach them before any change
+        LoadedSQLData(const LoadedSQLData& other);
+        LoadedSQLData& operator=(const LoadedSQLData& other) = delete;
+
         // dtor
         ~LoadedSQLData() = default;
 
         // m_sqlData getter / setter
-        std::vector<std::unique_ptr<SQLRow>>& sqlData();
+        std::vector<std::shared_ptr<SQLRow>>& sqlData();
+        const std::vector<std::shared_ptr<SQLRow>>& sqlData() const;
 
-        // m_columnIndexMap getter / setter
-        QHash<QString, int> columnIndexMap() const;
-        void setColumnIndexMap(const QHash<QString, int>& columnIndexMap);
+        // m_schema getter / setter
+        const std::shared_ptr<const SQLSchema>& schema() const;
+        void setSchema(std::shared_ptr<const SQLSchema> schema);
 
-        // m_indexColumnMap getter / setter
-        QMap<int, QString> indexColumnMap() const;
-        void setIndexColumnMap(const QMap<int, QString>& indexColumnMap);
+        // m_deferredSource getter / setter
+        const DeferredSource& deferredSource() const;
+        void setDeferredSource(const DeferredSource& deferredSource);
 
         // m_sqlData getter - moves row into internal data structure
-        void addRow(std::unique_ptr<SQLRow> row);
+        void addRow(std::shared_ptr<SQLRow> row);
 
-        // m_sqlDataTypes getter / setter
-        std::vector<QMetaType>& sqlDataTypes();
-        void setSqlDataTypes(const std::vector<QMetaType>& sqlDataTypes);
+        // returns approximate memory used by the data, in bytes
+        qint64 estimatedSize() const;
 
     private:
-        // raw sql data from db
-        std::vector<std::unique_ptr<SQLRow>> m_sqlData;
-
-        // sql column data types
-        std::vector<QMetaType> m_sqlDataTypes;
+        // raw sql data from db - rows can be shared by several data sets
+        std::vector<std::shared_ptr<SQLRow>> m_sqlData;
 
-        // map of column -> index relations
-        QHash<QString, int> m_columnIndexMap;
+        // column layout - shared by all data sets of the same query
+        std::shared_ptr<const SQLSchema> m_schema{ SQLSchema::empty() };
 
-        // map of index -> column relations
-        QMap<int, QString> m_indexColumnMap;
+        // source of cells not fetched during load
+        DeferredSource m_deferredSource;
     };
 
 }   // namespace IzSQLUtilities
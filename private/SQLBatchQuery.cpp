@@ -0,0 +1,71 @@
+﻿#include "SQLBatchQuery.h"
+
+#include <QSqlDriver>
+
+IzSQLUtilities::SQLBatchQuery::SQLBatchQuery(const QSqlDatabase& database)
+    : m_query(database)
+    , m_nativeBatch(database.driver() != nullptr && database.driver()->hasFeature(QSqlDriver::BatchOperations))
+{
+}
+
+bool IzSQLUtilities::SQLBatchQuery::prepare(const QString& sqlDefinition, const QStringList& placeholders)
+{
+    m_placeholders = placeholders;
+    return m_query.prepare(sqlDefinition);
+}
+
+bool IzSQLUtilities::SQLBatchQuery::exec(const std::vector<QVariantList>& columns, int offset, int count, int& failedRow)
+{
+    failedRow = -1;
+    if (count <= 0) {
+        return true;
+    }
+
+    if (m_nativeBatch) {
+        for (int c = 0; c < static_cast<int>(columns.size()); ++c) {
+            bind(c, offset == 0 && count == columns[c].size() ? columns[c] : columns[c].mid(offset, count));
+        }
+        return m_query.execBatch();
+    }
+
+    for (int r = offset; r < offset + count; ++r) {
+        if (!execRow(columns, r)) {
+            failedRow = r;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool IzSQLUtilities::SQLBatchQuery::execRow(const std::vector<QVariantList>& columns, int row)
+{
+    for (int c = 0; c < static_cast<int>(columns.size()); ++c) {
+        bind(c, columns[c].at(row));
+    }
+    return m_query.exec();
+}
+
+bool IzSQLUtilities::SQLBatchQuery::hasNativeBatch() const
+{
+    return m_nativeBatch;
+}
+
+QVariant IzSQLUtilities::SQLBatchQuery::lastInsertId() const
+{
+    return m_query.lastInsertId();
+}
+
+QSqlError IzSQLUtilities::SQLBatchQuery::lastError() const
+{
+    return m_query.lastError();
+}
+
+void IzSQLUtilities::SQLBatchQuery::bind(int column, const QVariant& value)
+{
+    if (m_placeholders.isEmpty()) {
+        m_query.bindValue(column, value);
+    } else {
+        m_query.bindValue(QStringLiteral(":") + m_placeholders[column], value);
+    }
+}
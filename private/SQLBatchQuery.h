@@ -0,0 +1,60 @@
+﻿#ifndef IZSQLUTILITIES_SQLBATCHQUERY_H
+#define IZSQLUTILITIES_SQLBATCHQUERY_H
+
+#include <vector>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariantList>
+
+namespace IzSQLUtilities
+{
+    // prepared statement executed over chunks of columnar parameter values
+    class SQLBatchQuery
+    {
+    public:
+        // ctor
+        explicit SQLBatchQuery(const QSqlDatabase& database);
+
+        // dtor
+        ~SQLBatchQuery() = default;
+
+        // prepares given statement
+        // placeholders - names of bound parameters, without ':', in order of columns - empty list means positional binding
+        bool prepare(const QString& sqlDefinition, const QStringList& placeholders = {});
+
+        // executes rows [offset, offset + count) of given columnar values
+        // uses native batch execution if driver supports it, otherwise reuses prepared statement row by row
+        // failedRow - on failure index of the failing row, -1 if native batch failed as a whole
+        bool exec(const std::vector<QVariantList>& columns, int offset, int count, int& failedRow);
+
+        // executes single row of given columnar values
+        bool execRow(const std::vector<QVariantList>& columns, int row);
+
+        // returns true if driver supports native batch execution
+        bool hasNativeBatch() const;
+
+        // returns key generated by the last executed row - see QSqlQuery::lastInsertId()
+        QVariant lastInsertId() const;
+
+        // returns last error
+        QSqlError lastError() const;
+
+    private:
+        // prepared query
+        QSqlQuery m_query;
+
+        // names of bound parameters
+        QStringList m_placeholders;
+
+        // true if driver supports native batch execution
+        bool m_nativeBatch{ false };
+
+        // binds value for given column
+        void bind(int column, const QVariant& value);
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLBATCHQUERY_H
@@ -0,0 +1,536 @@
+﻿#include "SQLColumnStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QtAlgorithms>
+
+namespace
+{
+    // version of QDataStream used for Other cells
+    constexpr QDataStream::Version streamVersion{ QDataStream::Qt_6_0 };
+
+    // maximum number of distinct values of dictionary encoded column
+    constexpr std::size_t maxDictionarySize{ 4096 };
+
+    // number of cells after which column with more than half of distinct values stops being dictionary encoded
+    constexpr std::size_t dictionaryProbeSize{ 1024 };
+
+    // number of cells of single frame-of-reference block
+    constexpr std::size_t packedBlockSize{ 128 };
+
+    // returns mask of lowest bitWidth bits
+    quint64 lowBits(quint8 bitWidth)
+    {
+        return bitWidth >= 64 ? std::numeric_limits<quint64>::max() : (quint64{ 1 } << bitWidth) - 1;
+    }
+
+    // reads index-th bitWidth wide offset of block starting at given word
+    quint64 unpack(const std::vector<quint64>& words, quint64 wordOffset, quint8 bitWidth, std::size_t index)
+    {
+        if (bitWidth == 0) {
+            return 0;
+        }
+
+        const quint64 bit = static_cast<quint64>(index) * bitWidth;
+        const quint64 word = wordOffset + bit / 64;
+        const quint64 shift = bit % 64;
+
+        quint64 offset = words[word] >> shift;
+        if (shift + bitWidth > 64) {
+            offset |= words[word + 1] << (64 - shift);
+        }
+
+        return offset & lowBits(bitWidth);
+    }
+}   // namespace
+
+template<typename T>
+void IzSQLUtilities::SQLColumnStore::appendBytes(Column& column, const T& value)
+{
+    const auto position = column.bytes.size();
+    column.bytes.resize(position + sizeof(T));
+    std::memcpy(column.bytes.data() + position, &value, sizeof(T));
+}
+
+template<typename T>
+T IzSQLUtilities::SQLColumnStore::readBytes(const Column& column, quint64 position)
+{
+    T value;
+    std::memcpy(&value, column.bytes.data() + position, sizeof(T));
+    return value;
+}
+
+IzSQLUtilities::SQLColumnStore::SQLColumnStore(const std::vector<QMetaType>& dataTypes)
+{
+    m_columns.resize(dataTypes.size());
+    for (std::size_t i = 0; i < dataTypes.size(); ++i) {
+        m_columns[i].type = dataTypes[i];
+        m_columns[i].dictionaryEncoding = dataTypes[i].id() == QMetaType::QString;
+    }
+}
+
+void IzSQLUtilities::SQLColumnStore::append(int column, const QVariant& value)
+{
+    auto& col = m_columns[static_cast<std::size_t>(column)];
+
+    if (value.isNull()) {
+        col.tags.push_back(CellTag::Null);
+    } else {
+        switch (value.typeId()) {
+        case QMetaType::Bool:
+            col.tags.push_back(CellTag::Bool);
+            appendBytes(col, value.toBool());
+            break;
+        case QMetaType::Int:
+            col.tags.push_back(CellTag::Int);
+            appendBytes(col, value.toInt());
+            break;
+        case QMetaType::LongLong:
+            col.tags.push_back(CellTag::LongLong);
+            appendBytes(col, value.toLongLong());
+            break;
+        case QMetaType::UInt:
+            col.tags.push_back(CellTag::UInt);
+            appendBytes(col, value.toUInt());
+            break;
+        case QMetaType::ULongLong:
+            col.tags.push_back(CellTag::ULongLong);
+            appendBytes(col, value.toULongLong());
+            break;
+        case QMetaType::Double:
+            col.tags.push_back(CellTag::Double);
+            appendBytes(col, value.toDouble());
+            break;
+        case QMetaType::QString:
+            appendString(col, value.toString());
+            break;
+        case QMetaType::QByteArray: {
+            col.tags.push_back(CellTag::ByteArray);
+            const QByteArray bytes = value.toByteArray();
+            col.bytes.insert(col.bytes.end(), bytes.cbegin(), bytes.cend());
+            break;
+        }
+        case QMetaType::QDate:
+            col.tags.push_back(CellTag::Date);
+            appendBytes(col, value.toDate().toJulianDay());
+            break;
+        case QMetaType::QTime:
+            col.tags.push_back(CellTag::Time);
+            appendBytes(col, value.toTime().msecsSinceStartOfDay());
+            break;
+        default: {
+            const QDateTime dateTime = value.typeId() == QMetaType::QDateTime ? value.toDateTime() : QDateTime();
+            if (dateTime.isValid() && dateTime.timeSpec() == Qt::LocalTime) {
+                col.tags.push_back(CellTag::LocalDateTime);
+                appendBytes(col, dateTime.toMSecsSinceEpoch());
+            } else if (dateTime.isValid() && dateTime.timeSpec() == Qt::UTC) {
+                col.tags.push_back(CellTag::UtcDateTime);
+                appendBytes(col, dateTime.toMSecsSinceEpoch());
+            } else {
+                col.tags.push_back(CellTag::Other);
+
+                QByteArray bytes;
+                QDataStream out(&bytes, QIODevice::WriteOnly);
+                out.setVersion(streamVersion);
+                out << value;
+                col.bytes.insert(col.bytes.end(), bytes.cbegin(), bytes.cend());
+            }
+            break;
+        }
+        }
+    }
+
+    col.offsets.push_back(col.bytes.size());
+}
+
+void IzSQLUtilities::SQLColumnStore::appendString(Column& column, const QString& value)
+{
+    if (column.dictionaryEncoding) {
+        auto it = column.dictionaryCodes.constFind(value);
+        if (it == column.dictionaryCodes.cend()) {
+            it = column.dictionaryCodes.insert(value, static_cast<quint32>(column.dictionary.size()));
+            column.dictionary.push_back(value);
+        }
+
+        column.tags.push_back(CellTag::Dictionary);
+        appendBytes(column, it.value());
+
+        // too many distinct values - already encoded cells keep their codes, new ones are stored as plain strings
+        if (column.dictionary.size() > maxDictionarySize || (column.tags.size() >= dictionaryProbeSize && column.dictionary.size() > column.tags.size() / 2)) {
+            column.dictionaryEncoding = false;
+            column.dictionaryCodes.clear();
+        }
+        return;
+    }
+
+    column.tags.push_back(CellTag::String);
+    const QByteArray utf8 = value.toUtf8();
+    column.bytes.insert(column.bytes.end(), utf8.cbegin(), utf8.cend());
+}
+
+void IzSQLUtilities::SQLColumnStore::squeeze()
+{
+    for (auto& column : m_columns) {
+        column.tags.shrink_to_fit();
+        column.offsets.shrink_to_fit();
+        column.bytes.shrink_to_fit();
+        column.dictionary.shrink_to_fit();
+        column.dictionaryCodes.clear();
+        column.dictionaryCodes.squeeze();
+
+        // order of dictionary values allows sorting by codes
+        std::vector<int> codes(column.dictionary.size());
+        std::iota(codes.begin(), codes.end(), 0);
+        std::sort(codes.begin(), codes.end(), [&column](int left, int right) {
+            return QString::compare(column.dictionary[static_cast<std::size_t>(left)], column.dictionary[static_cast<std::size_t>(right)], Qt::CaseSensitive) < 0;
+        });
+
+        column.dictionaryRanks.assign(codes.size(), 0);
+        for (std::size_t i = 0; i < codes.size(); ++i) {
+            column.dictionaryRanks[static_cast<std::size_t>(codes[i])] = static_cast<int>(i);
+        }
+
+        packColumn(column);
+    }
+}
+
+void IzSQLUtilities::SQLColumnStore::packColumn(Column& column)
+{
+    // only columns with single integral tag are packed
+    CellTag tag{ CellTag::Null };
+    bool hasNulls{ false };
+    for (const auto cellTag : column.tags) {
+        if (cellTag == CellTag::Null) {
+            hasNulls = true;
+        } else if (tag == CellTag::Null) {
+            tag = cellTag;
+        } else if (cellTag != tag) {
+            return;
+        }
+    }
+
+    switch (tag) {
+    case CellTag::Int:
+    case CellTag::LongLong:
+    case CellTag::UInt:
+    case CellTag::Date:
+    case CellTag::Time:
+    case CellTag::LocalDateTime:
+    case CellTag::UtcDateTime:
+        break;
+    default:
+        return;
+    }
+
+    const std::size_t rows = column.tags.size();
+    if (hasNulls) {
+        column.nullMask.assign((rows + 63) / 64, 0);
+        for (std::size_t row = 0; row < rows; ++row) {
+            if (column.tags[row] == CellTag::Null) {
+                column.nullMask[row / 64] |= quint64{ 1 } << (row % 64);
+            }
+        }
+    }
+
+    column.packedBlocks.reserve((rows + packedBlockSize - 1) / packedBlockSize);
+    for (std::size_t begin = 0; begin < rows; begin += packedBlockSize) {
+        const std::size_t end = std::min(begin + packedBlockSize, rows);
+
+        // null cells are stored as zero offsets
+        PackedBlock block;
+        bool first{ true };
+        for (std::size_t row = begin; row < end; ++row) {
+            if (column.tags[row] == CellTag::Null) {
+                continue;
+            }
+
+            const qint64 value = integralValue(column, row);
+            block.reference = first ? value : std::min(block.reference, value);
+            block.maximum = first ? value : std::max(block.maximum, value);
+            first = false;
+        }
+
+        const quint64 range = static_cast<quint64>(block.maximum) - static_cast<quint64>(block.reference);
+        block.bitWidth = static_cast<quint8>(64 - qCountLeadingZeroBits(range));
+        block.wordOffset = column.packedWords.size();
+        column.packedWords.resize(block.wordOffset + ((end - begin) * block.bitWidth + 63) / 64, 0);
+
+        if (block.bitWidth > 0) {
+            for (std::size_t row = begin; row < end; ++row) {
+                if (column.tags[row] == CellTag::Null) {
+                    continue;
+                }
+
+                const quint64 offset = static_cast<quint64>(integralValue(column, row)) - static_cast<quint64>(block.reference);
+                const quint64 bit = static_cast<quint64>(row - begin) * block.bitWidth;
+                const quint64 word = block.wordOffset + bit / 64;
+                const quint64 shift = bit % 64;
+
+                column.packedWords[word] |= offset << shift;
+                if (shift + block.bitWidth > 64) {
+                    column.packedWords[word + 1] |= offset >> (64 - shift);
+                }
+            }
+        }
+
+        column.packedBlocks.push_back(block);
+    }
+
+    column.packed = true;
+    column.packedTag = tag;
+    column.packedRows = rows;
+    column.packedWords.shrink_to_fit();
+
+    // raw cells are not needed anymore
+    std::vector<CellTag>().swap(column.tags);
+    std::vector<quint64>().swap(column.offsets);
+    std::vector<char>().swap(column.bytes);
+}
+
+qint64 IzSQLUtilities::SQLColumnStore::integralValue(const Column& column, std::size_t row)
+{
+    const quint64 position = column.offsets[row];
+
+    switch (column.tags[row]) {
+    case CellTag::Int:
+    case CellTag::Time:
+        return readBytes<int>(column, position);
+    case CellTag::UInt:
+        return readBytes<uint>(column, position);
+    case CellTag::LongLong:
+    case CellTag::Date:
+    case CellTag::LocalDateTime:
+    case CellTag::UtcDateTime:
+        return readBytes<qint64>(column, position);
+    default:
+        return 0;
+    }
+}
+
+qint64 IzSQLUtilities::SQLColumnStore::packedValue(const Column& column, std::size_t row)
+{
+    const auto& block = column.packedBlocks[row / packedBlockSize];
+    return static_cast<qint64>(static_cast<quint64>(block.reference) + unpack(column.packedWords, block.wordOffset, block.bitWidth, row % packedBlockSize));
+}
+
+bool IzSQLUtilities::SQLColumnStore::isPackedNull(const Column& column, std::size_t row)
+{
+    return !column.nullMask.empty() && (column.nullMask[row / 64] & (quint64{ 1 } << (row % 64))) != 0;
+}
+
+bool IzSQLUtilities::SQLColumnStore::integralBound(CellTag tag, const QVariant& bound, qint64& value)
+{
+    switch (tag) {
+    case CellTag::Int:
+    case CellTag::LongLong:
+    case CellTag::UInt:
+        switch (bound.typeId()) {
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+        case QMetaType::UInt:
+            value = bound.toLongLong();
+            return true;
+        case QMetaType::ULongLong:
+            value = static_cast<qint64>(std::min<qulonglong>(bound.toULongLong(), std::numeric_limits<qint64>::max()));
+            return true;
+        default:
+            return false;
+        }
+    case CellTag::Date:
+        if (bound.typeId() == QMetaType::QDate && bound.toDate().isValid()) {
+            value = bound.toDate().toJulianDay();
+            return true;
+        }
+        return false;
+    case CellTag::Time:
+        if (bound.typeId() == QMetaType::QTime && bound.toTime().isValid()) {
+            value = bound.toTime().msecsSinceStartOfDay();
+            return true;
+        }
+        return false;
+    case CellTag::LocalDateTime:
+    case CellTag::UtcDateTime:
+        if (bound.typeId() == QMetaType::QDateTime && bound.toDateTime().isValid()) {
+            value = bound.toDateTime().toMSecsSinceEpoch();
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+QVariant IzSQLUtilities::SQLColumnStore::value(std::size_t row, int column) const
+{
+    const auto& col = m_columns[static_cast<std::size_t>(column)];
+
+    if (col.packed) {
+        if (isPackedNull(col, row)) {
+            return QVariant(col.type);
+        }
+
+        const qint64 value = packedValue(col, row);
+        switch (col.packedTag) {
+        case CellTag::Int:
+            return static_cast<int>(value);
+        case CellTag::LongLong:
+            return static_cast<qlonglong>(value);
+        case CellTag::UInt:
+            return static_cast<uint>(value);
+        case CellTag::Date:
+            return QDate::fromJulianDay(value);
+        case CellTag::Time:
+            return QTime::fromMSecsSinceStartOfDay(static_cast<int>(value));
+        case CellTag::LocalDateTime:
+            return QDateTime::fromMSecsSinceEpoch(value, Qt::LocalTime);
+        case CellTag::UtcDateTime:
+            return QDateTime::fromMSecsSinceEpoch(value, Qt::UTC);
+        default:
+            return QVariant(col.type);
+        }
+    }
+
+    const quint64 begin = col.offsets[row];
+    const quint64 end = col.offsets[row + 1];
+
+    switch (col.tags[row]) {
+    case CellTag::Null:
+        return QVariant(col.type);
+    case CellTag::Bool:
+        return readBytes<bool>(col, begin);
+    case CellTag::Int:
+        return readBytes<int>(col, begin);
+    case CellTag::LongLong:
+        return readBytes<qlonglong>(col, begin);
+    case CellTag::UInt:
+        return readBytes<uint>(col, begin);
+    case CellTag::ULongLong:
+        return readBytes<qulonglong>(col, begin);
+    case CellTag::Double:
+        return readBytes<double>(col, begin);
+    case CellTag::String:
+        return QString::fromUtf8(col.bytes.data() + begin, static_cast<qsizetype>(end - begin));
+    case CellTag::ByteArray:
+        return QByteArray(col.bytes.data() + begin, static_cast<qsizetype>(end - begin));
+    case CellTag::Date:
+        return QDate::fromJulianDay(readBytes<qint64>(col, begin));
+    case CellTag::Time:
+        return QTime::fromMSecsSinceStartOfDay(readBytes<int>(col, begin));
+    case CellTag::LocalDateTime:
+        return QDateTime::fromMSecsSinceEpoch(readBytes<qint64>(col, begin), Qt::LocalTime);
+    case CellTag::UtcDateTime:
+        return QDateTime::fromMSecsSinceEpoch(readBytes<qint64>(col, begin), Qt::UTC);
+    case CellTag::Dictionary:
+        return col.dictionary[readBytes<quint32>(col, begin)];
+    case CellTag::Other:
+        break;
+    }
+
+    const QByteArray raw = QByteArray::fromRawData(col.bytes.data() + begin, static_cast<qsizetype>(end - begin));
+    QDataStream in(raw);
+    in.setVersion(streamVersion);
+
+    QVariant value;
+    in >> value;
+
+    return value;
+}
+
+qint64 IzSQLUtilities::SQLColumnStore::estimatedSize() const
+{
+    qint64 size{ 0 };
+    for (const auto& column : m_columns) {
+        size += static_cast<qint64>(column.tags.capacity() * sizeof(CellTag) + column.offsets.capacity() * sizeof(quint64) + column.bytes.capacity());
+        size += static_cast<qint64>(column.dictionaryRanks.capacity() * sizeof(int));
+        size += static_cast<qint64>(column.packedBlocks.capacity() * sizeof(PackedBlock) + (column.packedWords.capacity() + column.nullMask.capacity()) * sizeof(quint64));
+        for (const auto& value : column.dictionary) {
+            size += static_cast<qint64>(sizeof(QString) + value.size() * sizeof(QChar));
+        }
+    }
+
+    return size;
+}
+
+int IzSQLUtilities::SQLColumnStore::dictionarySize(int column) const
+{
+    return static_cast<int>(m_columns[static_cast<std::size_t>(column)].dictionary.size());
+}
+
+int IzSQLUtilities::SQLColumnStore::dictionaryCode(std::size_t row, int column) const
+{
+    const auto& col = m_columns[static_cast<std::size_t>(column)];
+    if (col.packed || col.tags[row] != CellTag::Dictionary) {
+        return -1;
+    }
+
+    return static_cast<int>(readBytes<quint32>(col, col.offsets[row]));
+}
+
+QVariant IzSQLUtilities::SQLColumnStore::dictionaryValue(int column, int code) const
+{
+    return m_columns[static_cast<std::size_t>(column)].dictionary[static_cast<std::size_t>(code)];
+}
+
+int IzSQLUtilities::SQLColumnStore::dictionaryRank(int column, int code) const
+{
+    return m_columns[static_cast<std::size_t>(column)].dictionaryRanks[static_cast<std::size_t>(code)];
+}
+
+std::vector<bool> IzSQLUtilities::SQLColumnStore::rangeMatches(int column, const QVariant& from, const QVariant& to) const
+{
+    const auto& col = m_columns[static_cast<std::size_t>(column)];
+    if (!col.packed) {
+        return {};
+    }
+
+    qint64 lower = std::numeric_limits<qint64>::min();
+    qint64 upper = std::numeric_limits<qint64>::max();
+    if ((!from.isNull() && !integralBound(col.packedTag, from, lower)) || (!to.isNull() && !integralBound(col.packedTag, to, upper))) {
+        return {};
+    }
+
+    std::vector<bool> matches(col.packedRows, false);
+    if (lower > upper) {
+        return matches;
+    }
+
+    for (std::size_t i = 0; i < col.packedBlocks.size(); ++i) {
+        const auto& block = col.packedBlocks[i];
+        const std::size_t begin = i * packedBlockSize;
+        const std::size_t end = std::min(begin + packedBlockSize, col.packedRows);
+
+        // whole block outside of the range
+        if (block.maximum < lower || block.reference > upper) {
+            continue;
+        }
+
+        // whole block inside of the range
+        if (block.reference >= lower && block.maximum <= upper) {
+            std::fill(matches.begin() + static_cast<std::ptrdiff_t>(begin), matches.begin() + static_cast<std::ptrdiff_t>(end), true);
+        } else {
+            // bounds are moved to block's offset domain so cells are compared without decoding
+            const quint64 lowerOffset = lower <= block.reference ? 0 : static_cast<quint64>(lower) - static_cast<quint64>(block.reference);
+            const quint64 upperOffset = static_cast<quint64>(std::min(upper, block.maximum)) - static_cast<quint64>(block.reference);
+
+            for (std::size_t row = begin; row < end; ++row) {
+                const quint64 offset = unpack(col.packedWords, block.wordOffset, block.bitWidth, row - begin);
+                matches[row] = offset >= lowerOffset && offset <= upperOffset;
+            }
+        }
+
+        if (!col.nullMask.empty()) {
+            for (std::size_t row = begin; row < end; ++row) {
+                if (isPackedNull(col, row)) {
+                    matches[row] = false;
+                }
+            }
+        }
+    }
+
+    return matches;
+}
@@ -0,0 +1,160 @@
+﻿#ifndef IZSQLUTILITIES_SQLCOLUMNSTORE_H
+#define IZSQLUTILITIES_SQLCOLUMNSTORE_H
+
+#include <vector>
+
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+
+#include "IzSQLUtilities/SQLRowSource.h"
+
+namespace IzSQLUtilities
+{
+    // compact, column oriented storage of raw query values
+    // cells are kept as type tag + bytes (strings as UTF-8, numbers and dates natively) and turned into QVariant only on access
+    // low cardinality string columns are detected while appending and kept as per column dictionary + integer codes
+    // integral, date and time columns are bit packed in frame-of-reference blocks by squeeze()
+    // WARNING: append() is not thread safe and has to be finished before rows start decoding values
+    class SQLColumnStore : public SQLRowSource
+    {
+    public:
+        // ctor
+        explicit SQLColumnStore(const std::vector<QMetaType>& dataTypes);
+
+        // dtor
+        ~SQLColumnStore() override = default;
+
+        SQLColumnStore(const SQLColumnStore& other) = delete;
+        SQLColumnStore(SQLColumnStore&& other) = delete;
+
+        // appends value to given column - columns have to be filled row by row
+        void append(int column, const QVariant& value);
+
+        // finishes appending - releases unused capacity, orders dictionaries and packs integral columns
+        void squeeze();
+
+        // SQLRowSource interface start
+
+        QVariant value(std::size_t row, int column) const override;
+        qint64 estimatedSize() const override;
+        int dictionarySize(int column) const override;
+        int dictionaryCode(std::size_t row, int column) const override;
+        QVariant dictionaryValue(int column, int code) const override;
+        int dictionaryRank(int column, int code) const override;
+        std::vector<bool> rangeMatches(int column, const QVariant& from, const QVariant& to) const override;
+
+        // SQLRowSource interface end
+
+    private:
+        // type of stored cell
+        enum class CellTag : quint8 {
+            Null = 0,
+            Bool,
+            Int,
+            LongLong,
+            UInt,
+            ULongLong,
+            Double,
+            String,
+            ByteArray,
+            Date,
+            Time,
+            LocalDateTime,
+            UtcDateTime,
+            Other,
+            Dictionary
+        };
+
+        // frame-of-reference block of packed column
+        struct PackedBlock {
+            // smallest value of the block - cells are stored as bitWidth wide offsets from it
+            qint64 reference{ 0 };
+
+            // largest value of the block
+            qint64 maximum{ 0 };
+
+            // position of block's first word in Column::packedWords
+            quint64 wordOffset{ 0 };
+
+            // width of single packed offset, in bits
+            quint8 bitWidth{ 0 };
+        };
+
+        // single column
+        struct Column {
+            // column type - used for null values
+            QMetaType type;
+
+            // tag of every cell
+            std::vector<CellTag> tags;
+
+            // (cells + 1) positions of cells' bytes
+            std::vector<quint64> offsets{ 0 };
+
+            // cells' bytes
+            std::vector<char> bytes;
+
+            // true while column's strings are dictionary encoded
+            bool dictionaryEncoding{ false };
+
+            // distinct values of dictionary encoded strings - code is an index in this vector
+            std::vector<QString> dictionary;
+
+            // value -> code relations, used only while appending
+            QHash<QString, quint32> dictionaryCodes;
+
+            // code -> position in case sensitive order of dictionary values
+            std::vector<int> dictionaryRanks;
+
+            // true if column's cells were moved to packed blocks - tags, offsets and bytes are empty then
+            bool packed{ false };
+
+            // tag shared by all non null cells of packed column
+            CellTag packedTag{ CellTag::Null };
+
+            // number of cells of packed column
+            std::size_t packedRows{ 0 };
+
+            // blocks of packed column
+            std::vector<PackedBlock> packedBlocks;
+
+            // bit packed offsets of all blocks
+            std::vector<quint64> packedWords;
+
+            // one bit per null cell of packed column, empty if column has no nulls
+            std::vector<quint64> nullMask;
+        };
+
+        // appends string cell to given column, dictionary encoding it if possible
+        static void appendString(Column& column, const QString& value);
+
+        // moves integral cells of given column to frame-of-reference blocks if all its non null cells share packable tag
+        static void packColumn(Column& column);
+
+        // returns integral value of given unpacked cell
+        static qint64 integralValue(const Column& column, std::size_t row);
+
+        // returns value of given packed cell
+        static qint64 packedValue(const Column& column, std::size_t row);
+
+        // returns true if given packed cell is null
+        static bool isPackedNull(const Column& column, std::size_t row);
+
+        // converts range bound to integral domain of given packed tag, returns false if it is not possible
+        static bool integralBound(CellTag tag, const QVariant& bound, qint64& value);
+
+        // stored columns
+        std::vector<Column> m_columns;
+
+        // appends raw bytes of fixed size value
+        template<typename T>
+        static void appendBytes(Column& column, const T& value);
+
+        // reads raw bytes of fixed size value
+        template<typename T>
+        static T readBytes(const Column& column, quint64 position);
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLCOLUMNSTORE_H
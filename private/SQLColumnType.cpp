@@ -0,0 +1,165 @@
+﻿#include "SQLColumnType.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+
+IzSQLUtilities::SQLColumnType::SQLColumnType(Kind kind, const QString& format)
+    : m_kind(kind)
+    , m_format(format)
+{
+}
+
+std::optional<IzSQLUtilities::SQLColumnType> IzSQLUtilities::SQLColumnType::parse(const QString& declaration)
+{
+    const int separator = declaration.indexOf(QLatin1Char(':'));
+    const QString name = declaration.left(separator).trimmed().toLower();
+    const QString format = separator == -1 ? QString() : declaration.mid(separator + 1).trimmed();
+
+    if (name == QStringLiteral("date")) {
+        return SQLColumnType(Kind::Date, format);
+    }
+    if (name == QStringLiteral("datetime")) {
+        return SQLColumnType(Kind::DateTime, format);
+    }
+    if (name == QStringLiteral("time")) {
+        return SQLColumnType(Kind::Time, format);
+    }
+
+    // only date and time types have format
+    if (separator != -1) {
+        return std::nullopt;
+    }
+
+    if (name == QStringLiteral("int")) {
+        return SQLColumnType(Kind::Int, {});
+    }
+    if (name == QStringLiteral("bool")) {
+        return SQLColumnType(Kind::Bool, {});
+    }
+    if (name == QStringLiteral("decimal")) {
+        return SQLColumnType(Kind::Decimal, {});
+    }
+    if (name == QStringLiteral("json")) {
+        return SQLColumnType(Kind::Json, {});
+    }
+
+    return std::nullopt;
+}
+
+QMetaType IzSQLUtilities::SQLColumnType::metaType() const
+{
+    switch (m_kind) {
+    case Kind::Int:
+        return QMetaType::fromType<qlonglong>();
+    case Kind::Bool:
+        return QMetaType::fromType<bool>();
+    case Kind::Decimal:
+        return QMetaType::fromType<double>();
+    case Kind::Json:
+        return QMetaType::fromType<QJsonValue>();
+    case Kind::Date:
+        return QMetaType::fromType<QDate>();
+    case Kind::DateTime:
+        return QMetaType::fromType<QDateTime>();
+    case Kind::Time:
+        return QMetaType::fromType<QTime>();
+    }
+
+    return {};
+}
+
+QVariant IzSQLUtilities::SQLColumnType::coerce(const QVariant& value) const
+{
+    if (value.isNull()) {
+        return QVariant(metaType());
+    }
+
+    // values of the declared type need no conversion
+    if (value.metaType() == metaType()) {
+        return value;
+    }
+
+    const bool isText = value.typeId() == QMetaType::QString || value.typeId() == QMetaType::QByteArray;
+    const QString text = isText ? value.toString().trimmed() : QString();
+
+    switch (m_kind) {
+    case Kind::Int: {
+        bool ok{ false };
+        const qlonglong result = isText ? text.toLongLong(&ok) : value.toLongLong(&ok);
+        return ok ? QVariant(result) : QVariant(metaType());
+    }
+    case Kind::Bool: {
+        if (!isText) {
+            return value.toBool();
+        }
+
+        const QString lowered = text.toLower();
+        if (lowered == QStringLiteral("1") || lowered == QStringLiteral("true") || lowered == QStringLiteral("t") || lowered == QStringLiteral("yes") || lowered == QStringLiteral("y")) {
+            return true;
+        }
+        if (lowered == QStringLiteral("0") || lowered == QStringLiteral("false") || lowered == QStringLiteral("f") || lowered == QStringLiteral("no") || lowered == QStringLiteral("n")) {
+            return false;
+        }
+        return QVariant(metaType());
+    }
+    case Kind::Decimal: {
+        bool ok{ false };
+        const double result = isText ? text.toDouble(&ok) : value.toDouble(&ok);
+        return ok ? QVariant(result) : QVariant(metaType());
+    }
+    case Kind::Json: {
+        if (!isText) {
+            return QVariant::fromValue(QJsonValue::fromVariant(value));
+        }
+
+        // document is wrapped in an array - top level scalars are not accepted by QJsonDocument
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson('[' + value.toByteArray() + ']', &error);
+        if (error.error != QJsonParseError::NoError || document.array().size() != 1) {
+            return QVariant(metaType());
+        }
+        return QVariant::fromValue(document.array().first());
+    }
+    case Kind::Date: {
+        if (!isText) {
+            return value.toDate().isValid() ? QVariant(value.toDate()) : QVariant(metaType());
+        }
+
+        // ISO date time strings are accepted as well
+        const QDate date = m_format.isEmpty() ? QDate::fromString(text.left(10), Qt::ISODate) : QDate::fromString(text, m_format);
+        return date.isValid() ? QVariant(date) : QVariant(metaType());
+    }
+    case Kind::DateTime: {
+        if (!isText) {
+            return value.toDateTime().isValid() ? QVariant(value.toDateTime()) : QVariant(metaType());
+        }
+
+        QDateTime dateTime;
+        if (m_format.isEmpty()) {
+            dateTime = QDateTime::fromString(text, Qt::ISODateWithMs);
+
+            // sql style 'yyyy-MM-dd HH:mm:ss' separator
+            if (!dateTime.isValid() && text.size() > 10 && text.at(10) == QLatin1Char(' ')) {
+                QString isoText = text;
+                isoText[10] = QLatin1Char('T');
+                dateTime = QDateTime::fromString(isoText, Qt::ISODateWithMs);
+            }
+        } else {
+            dateTime = QDateTime::fromString(text, m_format);
+        }
+        return dateTime.isValid() ? QVariant(dateTime) : QVariant(metaType());
+    }
+    case Kind::Time: {
+        if (!isText) {
+            return value.toTime().isValid() ? QVariant(value.toTime()) : QVariant(metaType());
+        }
+
+        const QTime time = m_format.isEmpty() ? QTime::fromString(text, Qt::ISODateWithMs) : QTime::fromString(text, m_format);
+        return time.isValid() ? QVariant(time) : QVariant(metaType());
+    }
+    }
+
+    return QVariant(metaType());
+}
@@ -0,0 +1,51 @@
+﻿#ifndef IZSQLUTILITIES_SQLCOLUMNTYPE_H
+#define IZSQLUTILITIES_SQLCOLUMNTYPE_H
+
+#include <optional>
+
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+
+namespace IzSQLUtilities
+{
+    // declared target type of loaded column - raw values are coerced to it once, during load
+    // declaration format: int, bool, decimal, json, date[:format], datetime[:format], time[:format]
+    // dates without format are parsed as ISO 8601, decimals are kept as double - digits past its precision are lost
+    // json declaration accepts any json value, including scalars
+    class SQLColumnType
+    {
+    public:
+        // kind of declared type
+        enum class Kind : uint8_t {
+            Int = 0,
+            Bool,
+            Decimal,
+            Json,
+            Date,
+            DateTime,
+            Time
+        };
+
+        // returns type of given declaration or std::nullopt if it is invalid
+        static std::optional<SQLColumnType> parse(const QString& declaration);
+
+        // returns meta type of coerced values
+        QMetaType metaType() const;
+
+        // returns value coerced to this type - values which can not be coerced become null
+        QVariant coerce(const QVariant& value) const;
+
+    private:
+        // ctor
+        SQLColumnType(Kind kind, const QString& format);
+
+        // kind of the type
+        Kind m_kind;
+
+        // format of date and time strings - empty for ISO 8601
+        QString m_format;
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLCOLUMNTYPE_H
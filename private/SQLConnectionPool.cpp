@@ -0,0 +1,62 @@
+﻿#include "IzSQLUtilities/SQLConnectionPool.h"
+
+#include <QHash>
+#include <QThreadStorage>
+
+#include "IzSQLUtilities/SQLConnector.h"
+
+namespace
+{
+    // connections of a single thread
+    using ThreadConnections = QHash<QString, std::shared_ptr<IzSQLUtilities::SqlConnector>>;
+
+    QThreadStorage<ThreadConnections> threadConnections;
+
+    // returns key identifying given database
+    QString connectionKey(IzSQLUtilities::DatabaseType databaseType, const QVariantMap& connectionParameters)
+    {
+        QString key = QString::number(static_cast<int>(databaseType));
+
+        QMapIterator<QString, QVariant> it(connectionParameters);
+        while (it.hasNext()) {
+            it.next();
+            key += QLatin1Char('\x1f') + it.key() + QLatin1Char('=') + it.value().toString();
+        }
+
+        return key;
+    }
+}   // namespace
+
+std::shared_ptr<IzSQLUtilities::SqlConnector> IzSQLUtilities::SQLConnectionPool::connection(DatabaseType databaseType, const QVariantMap& connectionParameters)
+{
+    auto& connections = threadConnections.localData();
+    const QString key = connectionKey(databaseType, connectionParameters);
+
+    auto it = connections.constFind(key);
+    if (it != connections.cend() && it.value()->getConnection().isOpen()) {
+        return it.value();
+    }
+
+    auto connector = std::make_shared<SqlConnector>(databaseType, connectionParameters);
+    if (connector->getConnection().isOpen()) {
+        connections.insert(key, connector);
+    } else {
+        connections.remove(key);
+    }
+
+    return connector;
+}
+
+void IzSQLUtilities::SQLConnectionPool::releaseConnection(DatabaseType databaseType, const QVariantMap& connectionParameters)
+{
+    if (threadConnections.hasLocalData()) {
+        threadConnections.localData().remove(connectionKey(databaseType, connectionParameters));
+    }
+}
+
+void IzSQLUtilities::SQLConnectionPool::releaseConnections()
+{
+    if (threadConnections.hasLocalData()) {
+        threadConnections.localData().clear();
+    }
+}
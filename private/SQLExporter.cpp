@@ -0,0 +1,395 @@
+﻿#include "IzSQLUtilities/SQLExporter.h"
+
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include "IzSQLUtilities/SQLQueryStream.h"
+#include "IzSQLUtilities/SQLTableModel.h"
+#include "IzSQLUtilities/SQLTableProxyModel.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
+
+namespace
+{
+    // size of the buffer after which it is written to the file
+    constexpr int exportBufferSize{ 1024 * 1024 };
+
+    // number of rows between progress signals
+    constexpr qint64 progressInterval{ 10000 };
+
+    // buffered writer of exported rows
+    class ExportWriter
+    {
+    public:
+        // ctor
+        ExportWriter(const QString& filePath, IzSQLUtilities::SQLExporter::ExportFormat format, const QString& csvSeparator, const QStringList& columnNames)
+            : m_file(filePath)
+            , m_format(format)
+            , m_csvSeparator(csvSeparator)
+            , m_columnNames(columnNames)
+        {
+            m_buffer.reserve(exportBufferSize + 64 * 1024);
+        }
+
+        // opens file and writes CSV header
+        bool open()
+        {
+            if (!m_file.open(QIODevice::WriteOnly)) {
+                return false;
+            }
+
+            if (m_format == IzSQLUtilities::SQLExporter::ExportFormat::CSV) {
+                for (int c = 0; c < m_columnNames.size(); ++c) {
+                    if (c > 0) {
+                        m_buffer += m_csvSeparator.toUtf8();
+                    }
+                    appendCsvField(m_columnNames[c]);
+                }
+                m_buffer += '\n';
+            }
+
+            return true;
+        }
+
+        // writes single row - value(column) returns value of given output column
+        template<typename ValueGetter>
+        bool writeRow(ValueGetter&& value)
+        {
+            if (m_format == IzSQLUtilities::SQLExporter::ExportFormat::CSV) {
+                for (int c = 0; c < m_columnNames.size(); ++c) {
+                    if (c > 0) {
+                        m_buffer += m_csvSeparator.toUtf8();
+                    }
+
+                    const QVariant cell = value(c);
+                    if (!cell.isNull()) {
+                        appendCsvField(cell.toString());
+                    }
+                }
+            } else {
+                QJsonObject object;
+                for (int c = 0; c < m_columnNames.size(); ++c) {
+                    object.insert(m_columnNames[c], QJsonValue::fromVariant(value(c)));
+                }
+                m_buffer += QJsonDocument(object).toJson(QJsonDocument::Compact);
+            }
+            m_buffer += '\n';
+
+            return m_buffer.size() < exportBufferSize || flush();
+        }
+
+        // writes buffered data and commits the file
+        bool commit()
+        {
+            return flush() && m_file.commit();
+        }
+
+        // discards written data
+        void discard()
+        {
+            m_file.cancelWriting();
+        }
+
+        // returns last error
+        QString errorString() const
+        {
+            return m_file.errorString();
+        }
+
+    private:
+        // output file - replaced atomically on commit
+        QSaveFile m_file;
+
+        // output format
+        IzSQLUtilities::SQLExporter::ExportFormat m_format;
+
+        // separator of CSV fields
+        QString m_csvSeparator;
+
+        // names of output columns
+        QStringList m_columnNames;
+
+        // pending data
+        QByteArray m_buffer;
+
+        // writes pending data
+        bool flush()
+        {
+            if (m_buffer.isEmpty()) {
+                return true;
+            }
+
+            const bool res = m_file.write(m_buffer) == m_buffer.size();
+            m_buffer.clear();
+
+            return res;
+        }
+
+        // appends CSV field - quoted if needed
+        void appendCsvField(const QString& field)
+        {
+            if (field.contains(m_csvSeparator) || field.contains(QLatin1Char('"')) || field.contains(QLatin1Char('\n')) || field.contains(QLatin1Char('\r'))) {
+                QString quoted = field;
+                quoted.replace(QStringLiteral("\""), QStringLiteral("\"\""));
+                m_buffer += '"';
+                m_buffer += quoted.toUtf8();
+                m_buffer += '"';
+            } else {
+                m_buffer += field.toUtf8();
+            }
+        }
+    };
+}   // namespace
+
+IzSQLUtilities::SQLExporter::SQLExporter(QObject* parent)
+    : QObject(parent)
+{
+}
+
+IzSQLUtilities::SQLExporter::~SQLExporter()
+{
+    // worker emits progress() of this exporter - it has to finish before destruction
+    cancel();
+    m_exportFuture.waitForFinished();
+}
+
+bool IzSQLUtilities::SQLExporter::exportView(IzSQLUtilities::SQLTableProxyModel* view, const QString& filePath, IzSQLUtilities::SQLExporter::ExportFormat format)
+{
+    if (view == nullptr) {
+        qCritical() << "Cannot export view - got null view.";
+        return false;
+    }
+
+    if (view->source() == nullptr) {
+        qCritical() << "Cannot export view - view has no source model.";
+        return false;
+    }
+
+    if (view->source()->isRefreshingData() || view->isFiltering()) {
+        qCritical() << "Cannot export view - its model is refreshing or filtering data.";
+        return false;
+    }
+
+    // rows of the view are mapped through its first column
+    if (view->columnCount() == 0) {
+        qCritical() << "Cannot export view - it has no visible columns.";
+        return false;
+    }
+
+    // pending cells would be exported as nulls
+    for (int i = 0; i < view->columnCount(); ++i) {
+        if (view->source()->isDeferredColumn(view->sourceColumn(i))) {
+            qCritical() << "Cannot export view - column" << view->source()->columnNameFromIndex(view->sourceColumn(i)) << "is deferred.";
+            return false;
+        }
+    }
+
+    if (!beginExport()) {
+        return false;
+    }
+
+    // snapshot of view layout - rows in sort order, visible columns only
+    // rows are shared with the source model, which copies them before changing - export reads rows as they were at its start
+    const SQLTableModel* source = view->source();
+    std::vector<std::shared_ptr<const SQLRow>> rows;
+    rows.reserve(static_cast<std::size_t>(view->rowCount()));
+    for (int i = 0; i < view->rowCount(); ++i) {
+        rows.push_back(*(source->cbegin() + view->sourceRow(i)));
+    }
+
+    std::vector<int> columns;
+    QStringList columnNames;
+    for (int i = 0; i < view->columnCount(); ++i) {
+        columns.push_back(view->sourceColumn(i));
+        columnNames.append(view->headerData(i).toString());
+    }
+
+    auto task = [this, rows = std::move(rows), columns = std::move(columns), columnNames, filePath, format, separator = m_csvSeparator]() -> ExportResult {
+        ExportWriter writer(filePath, format, separator, columnNames);
+        if (!writer.open()) {
+            return { false, 0, writer.errorString() };
+        }
+
+        const auto totalRows = static_cast<qint64>(rows.size());
+        qint64 writtenRows{ 0 };
+
+        for (const auto& row : rows) {
+            if (m_cancelRequested) {
+                writer.discard();
+                return { false, writtenRows, QStringLiteral("Export cancelled.") };
+            }
+
+            const SQLRow& sqlRow = *row;
+            if (!writer.writeRow([&sqlRow, &columns](int column) { return sqlRow.columnValue(columns[static_cast<std::size_t>(column)]); })) {
+                writer.discard();
+                return { false, writtenRows, writer.errorString() };
+            }
+
+            if (++writtenRows % progressInterval == 0) {
+                emit progress(writtenRows, totalRows);
+            }
+        }
+
+        if (!writer.commit()) {
+            return { false, writtenRows, writer.errorString() };
+        }
+        emit progress(writtenRows, totalRows);
+
+        return { true, writtenRows, {} };
+    };
+
+    m_exportFuture = QtConcurrent::run(task);
+    m_exportFuture.then(this, [this](const ExportResult& result) {
+        onExportFinished(result);
+    });
+
+    return true;
+}
+
+bool IzSQLUtilities::SQLExporter::exportQuery(const QString& sqlDefinition, const QVariantMap& parameters, const QString& filePath, IzSQLUtilities::SQLExporter::ExportFormat format)
+{
+    if (sqlDefinition.isEmpty()) {
+        qCritical() << "Cannot export query - sql definition is empty.";
+        return false;
+    }
+
+    if (!beginExport()) {
+        return false;
+    }
+
+    auto task = [this, sqlDefinition, parameters, filePath, format, separator = m_csvSeparator, databaseType = m_databaseType, connectionParameters = m_connectionParameters]() -> ExportResult {
+        SQLQueryStream stream(sqlDefinition, parameters, 5000, databaseType, connectionParameters);
+        if (!stream.exec()) {
+            return { false, 0, stream.lastError().text() };
+        }
+
+        ExportWriter writer(filePath, format, separator, stream.batch().columnNames());
+        if (!writer.open()) {
+            return { false, 0, writer.errorString() };
+        }
+
+        qint64 writtenRows{ 0 };
+        while (stream.next()) {
+            if (m_cancelRequested) {
+                writer.discard();
+                return { false, writtenRows, QStringLiteral("Export cancelled.") };
+            }
+
+            const auto& batch = stream.batch();
+            for (int r = 0; r < batch.rowCount(); ++r) {
+                if (!writer.writeRow([&batch, r](int column) { return batch.value(r, column); })) {
+                    writer.discard();
+                    return { false, writtenRows, writer.errorString() };
+                }
+            }
+
+            writtenRows += batch.rowCount();
+            emit progress(writtenRows, -1);
+        }
+
+        if (stream.lastError().isValid()) {
+            writer.discard();
+            return { false, writtenRows, stream.lastError().text() };
+        }
+
+        if (!writer.commit()) {
+            return { false, writtenRows, writer.errorString() };
+        }
+
+        return { true, writtenRows, {} };
+    };
+
+    m_exportFuture = SQLThreadPool::run(SQLThreadPool::target(m_databaseType, m_connectionParameters), SQLThreadPool::Priority::Background, task);
+    m_exportFuture.then(this, [this](const ExportResult& result) {
+        onExportFinished(result);
+    });
+
+    return true;
+}
+
+void IzSQLUtilities::SQLExporter::cancel()
+{
+    if (m_isExporting) {
+        m_cancelRequested = true;
+    }
+}
+
+bool IzSQLUtilities::SQLExporter::beginExport()
+{
+    if (m_isExporting) {
+        qCritical() << "Cannot start export - another export is in progress.";
+        return false;
+    }
+
+    m_cancelRequested = false;
+    m_isExporting = true;
+    emit isExportingChanged();
+
+    return true;
+}
+
+void IzSQLUtilities::SQLExporter::onExportFinished(const ExportResult& result)
+{
+    if (result.succeeded) {
+        qInfo() << "Exported" << result.rows << "rows.";
+    } else {
+        qWarning() << "Export failed after" << result.rows << "rows:" << result.error;
+    }
+
+    m_isExporting = false;
+    emit isExportingChanged();
+    emit exportFinished(result.succeeded, result.rows, result.error);
+}
+
+bool IzSQLUtilities::SQLExporter::isExporting() const
+{
+    return m_isExporting;
+}
+
+QString IzSQLUtilities::SQLExporter::csvSeparator() const
+{
+    return m_csvSeparator;
+}
+
+void IzSQLUtilities::SQLExporter::setCsvSeparator(const QString& csvSeparator)
+{
+    if (csvSeparator.isEmpty()) {
+        qWarning() << "CSV separator cannot be empty.";
+        return;
+    }
+
+    if (m_csvSeparator != csvSeparator) {
+        m_csvSeparator = csvSeparator;
+        emit csvSeparatorChanged();
+    }
+}
+
+QVariantMap IzSQLUtilities::SQLExporter::connectionParameters() const
+{
+    return m_connectionParameters;
+}
+
+void IzSQLUtilities::SQLExporter::setConnectionParameters(const QVariantMap& connectionParameters)
+{
+    if (m_connectionParameters != connectionParameters) {
+        m_connectionParameters = connectionParameters;
+    }
+}
+
+IzSQLUtilities::DatabaseType IzSQLUtilities::SQLExporter::databaseType() const
+{
+    return m_databaseType;
+}
+
+void IzSQLUtilities::SQLExporter::setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType)
+{
+    if (m_databaseType != databaseType) {
+        m_databaseType = databaseType;
+    }
+}
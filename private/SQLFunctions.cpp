@@ -1,14 +1,77 @@
 ﻿#include "IzSQLUtilities/SQLFunctions.h"
 
+#include <algorithm>
+
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QMetaProperty>
 #include <QSqlError>
 #include <QSqlQuery>
 
+#include <QtConcurrent>
+
 #include "IzSQLUtilities/IzSQLUtilities_Enums.h"
+#include "IzSQLUtilities/SQLConnectionPool.h"
 #include "IzSQLUtilities/SQLConnector.h"
 #include "IzSQLUtilities/SQLErrorEvent.h"
+#include "IzSQLUtilities/SQLQueryStream.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
+
+#include "SQLBatchQuery.h"
+
+namespace
+{
+    // result of asynchronous sql call
+    struct CallResult {
+        // true if call succeeded
+        bool succeeded{ false };
+
+        // first column of the first returned row
+        QVariant value;
+
+        // error of failed call
+        QSqlError error;
+    };
+
+    // executes given sql on pooled connection of the calling thread
+    CallResult executeCall(IzSQLUtilities::DatabaseType databaseType, const QVariantMap& connectionParameters, const QString& sqlDefinition, const QVariantMap& parameters, bool fetchValue)
+    {
+        auto db = IzSQLUtilities::SQLConnectionPool::connection(databaseType, connectionParameters);
+        if (!db->getConnection().isOpen()) {
+            return { false, {}, db->lastError() };
+        }
+
+        CallResult result;
+        {
+            QSqlQuery query(db->getConnection());
+            query.setForwardOnly(true);
+            query.prepare(sqlDefinition);
+
+            QMapIterator<QString, QVariant> i(parameters);
+            while (i.hasNext()) {
+                i.next();
+                query.bindValue(QStringLiteral(":") + i.key(), i.value());
+            }
+
+            if (query.exec()) {
+                result.succeeded = true;
+                if (fetchValue && query.next()) {
+                    result.value = query.value(0);
+                }
+            } else {
+                result.error = query.lastError();
+            }
+        }
+
+        // broken connections are not reused
+        if (result.error.type() == QSqlError::ConnectionError) {
+            IzSQLUtilities::SQLConnectionPool::releaseConnection(databaseType, connectionParameters);
+        }
+
+        return result;
+    }
+}   // namespace
 
 IzSQLUtilities::SQLFunctions::SQLFunctions(QObject* parent)
     : QObject(parent)
@@ -151,20 +214,205 @@ bool IzSQLUtilities::SQLFunctions::callProcedureStatic(const char* functionName,
     return false;
 }
 
+bool IzSQLUtilities::SQLFunctions::bulkExecute(const QString& sqlDefinition, const QStringList& columns, const QVariantList& columnValues, int commitInterval)
+{
+    if (sqlDefinition.isEmpty() || columns.isEmpty() || columns.size() != columnValues.size() || commitInterval <= 0) {
+        qCritical() << "Sql definition, columns list or commit interval invalid.";
+        return false;
+    }
+
+    // columnar values
+    std::vector<QVariantList> values;
+    values.reserve(static_cast<std::size_t>(columnValues.size()));
+    for (const auto& column : columnValues) {
+        values.push_back(column.toList());
+    }
+
+    const int rowsCount = static_cast<int>(values.front().size());
+    for (const auto& column : values) {
+        if (column.size() != rowsCount) {
+            qCritical() << "All columns passed to bulkExecute() have to have equal number of values.";
+            return false;
+        }
+    }
+
+    SqlConnector db(m_databaseType, m_connectionParameters);
+    if (!db.getConnection().isOpen()) {
+        SQLErrorEvent::postSQLError(db.lastError());
+        return false;
+    }
+
+    QSqlDatabase database = db.getConnection();
+    SQLBatchQuery query(database);
+    if (!query.prepare(sqlDefinition, columns)) {
+        SQLErrorEvent::postSQLError(query.lastError());
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int commitedRows{ 0 };
+    bool res{ true };
+
+    for (int offset = 0; offset < rowsCount; offset += commitInterval) {
+        const int count = std::min(commitInterval, rowsCount - offset);
+
+        if (!database.transaction()) {
+            SQLErrorEvent::postSQLError(database.lastError());
+            res = false;
+            break;
+        }
+
+        int failedRow{ -1 };
+        if (!query.exec(values, offset, count, failedRow)) {
+            if (failedRow != -1) {
+                qWarning() << "Execution failed at row:" << failedRow;
+            }
+            SQLErrorEvent::postSQLError(query.lastError());
+            database.rollback();
+            res = false;
+            break;
+        }
+
+        if (!database.commit()) {
+            SQLErrorEvent::postSQLError(database.lastError());
+            database.rollback();
+            res = false;
+            break;
+        }
+
+        commitedRows += count;
+    }
+
+    const double seconds = std::max(timer.nsecsElapsed(), qint64{ 1 }) / 1e9;
+    const double rowsPerSecond = commitedRows / seconds;
+
+    qInfo() << "Bulk execute commited" << commitedRows << "of" << rowsCount << "rows in" << seconds << "s -" << rowsPerSecond << "rows/s"
+            << (query.hasNativeBatch() ? "(native batch)." : "(prepared statement).");
+    emit bulkExecuted(commitedRows, rowsPerSecond);
+
+    return res;
+}
+
+QFuture<bool> IzSQLUtilities::SQLFunctions::callProcedureAsync(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters)
+{
+    emit operationStarted(functionName);
+
+    return QtConcurrent::run(SQLThreadPool::instance(), executeCall, m_databaseType, m_connectionParameters, sqlDefinition, parameters, false)
+        .then(this, [this, functionName](const CallResult& result) -> bool {
+            if (result.succeeded) {
+                qInfo() << "Function:" << functionName << "executed.";
+                emit success(functionName);
+            } else {
+                SQLErrorEvent::postSQLError(result.error);
+                emit failed(functionName, result.error.text());
+            }
+            emit operationEnded(functionName);
+
+            return result.succeeded;
+        });
+}
+
+QFuture<QVariant> IzSQLUtilities::SQLFunctions::queryValueAsync(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters)
+{
+    emit operationStarted(functionName);
+
+    return QtConcurrent::run(SQLThreadPool::instance(), executeCall, m_databaseType, m_connectionParameters, sqlDefinition, parameters, true)
+        .then(this, [this, functionName](const CallResult& result) -> QVariant {
+            if (result.succeeded) {
+                emit valueReturned(functionName, result.value);
+                emit success(functionName);
+            } else {
+                SQLErrorEvent::postSQLError(result.error);
+                emit failed(functionName, result.error.text());
+            }
+            emit operationEnded(functionName);
+
+            return result.value;
+        });
+}
+
+QFuture<bool> IzSQLUtilities::SQLFunctions::objectNameAvailableAsync(const QString& table, const QString& column, const QString& object)
+{
+    const QString sqlDefinition = QStringLiteral("SELECT COUNT(id) FROM ") + sanitize(table) + QStringLiteral(" WHERE ") + sanitize(column) + QStringLiteral(" = :object");
+
+    emit operationStarted(object);
+
+    return QtConcurrent::run(SQLThreadPool::instance(), executeCall, m_databaseType, m_connectionParameters, sqlDefinition, QVariantMap{ { QStringLiteral("object"), object } }, true)
+        .then(this, [this, object](const CallResult& result) -> bool {
+            if (!result.succeeded) {
+                qCritical() << result.error.text();
+                SQLErrorEvent::postSQLError(result.error);
+                emit failed(object, result.error.text());
+                emit operationEnded(object);
+
+                return false;
+            }
+
+            const bool available = result.value.toInt() == 0;
+            emit objectNameChecked(object, available);
+            emit operationEnded(object);
+
+            return available;
+        });
+}
+
+void IzSQLUtilities::SQLFunctions::startProcedureCall(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters)
+{
+    callProcedureAsync(functionName, sqlDefinition, parameters);
+}
+
+void IzSQLUtilities::SQLFunctions::startValueQuery(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters)
+{
+    queryValueAsync(functionName, sqlDefinition, parameters);
+}
+
+void IzSQLUtilities::SQLFunctions::startObjectNameCheck(const QString& table, const QString& column, const QString& object)
+{
+    objectNameAvailableAsync(table, column, object);
+}
+
+bool IzSQLUtilities::SQLFunctions::streamQuery(const QString& sqlDefinition, const QVariantMap& parameters, const std::function<bool(const SQLRowBatch&)>& callback, int batchSize) const
+{
+    SQLQueryStream stream(sqlDefinition, parameters, batchSize, m_databaseType, m_connectionParameters);
+    if (!stream.exec()) {
+        return false;
+    }
+
+    while (stream.next()) {
+        if (!callback(stream.batch())) {
+            qInfo() << "Streaming stopped by callback after" << stream.fetchedRows() << "rows.";
+            return true;
+        }
+    }
+
+    return !stream.lastError().isValid();
+}
+
 bool IzSQLUtilities::SQLFunctions::objectNameAvailable(const QString& table, const QString& column, const QString& object)
 {
     QString tTable = sanitize(table);
     QString tColumn = sanitize(column);
-    QString tObject = sanitize(object);
+
+    // object is bound as is - cache key matches the value queried, like in objectNamesAvailable()
+    const QString cacheKey = availabilityCacheKey(tTable, tColumn, object);
+    bool available{ false };
+    if (cachedAvailability(cacheKey, available)) {
+        return available;
+    }
 
     SqlConnector db(m_databaseType, m_connectionParameters);
     if (db.getConnection().isOpen()) {
         QSqlQuery query(db.getConnection());
-        query.prepare(QStringLiteral("SELECT COUNT(id) FROM ") + tTable + QStringLiteral(" WHERE ") + tColumn + QStringLiteral(" = '") + tObject + QStringLiteral("'"));
+        query.prepare(QStringLiteral("SELECT COUNT(id) FROM ") + tTable + QStringLiteral(" WHERE ") + tColumn + QStringLiteral(" = :object"));
+        query.bindValue(QStringLiteral(":object"), object);
 
         if (query.exec()) {
             query.first();
-            return (query.value(0).toInt() == 0);
+            available = (query.value(0).toInt() == 0);
+            cacheAvailability(cacheKey, available);
+            return available;
         }
 
         qCritical() << query.lastError().text();
@@ -176,19 +424,61 @@ bool IzSQLUtilities::SQLFunctions::objectNameAvailable(const QString& table, con
     return false;
 }
 
+QHash<QString, bool> IzSQLUtilities::SQLFunctions::objectNamesAvailable(const QString& table, const QString& column, const QStringList& objects, int chunkSize)
+{
+    QHash<QString, bool> result;
+    if (chunkSize <= 0) {
+        qCritical() << "Got invalid chunk size:" << chunkSize;
+        return result;
+    }
+
+    QString tTable = sanitize(table);
+    QString tColumn = sanitize(column);
+
+    // objects not served by cache
+    QStringList candidates;
+    for (const auto& object : objects) {
+        if (result.contains(object)) {
+            continue;
+        }
+
+        bool available{ false };
+        if (cachedAvailability(availabilityCacheKey(tTable, tColumn, object), available)) {
+            result.insert(object, available);
+        } else {
+            result.insert(object, true);
+            candidates.append(object);
+        }
+    }
+
+    if (candidates.isEmpty()) {
+        return result;
+    }
+
+    if (!queryAvailability(tTable, tColumn, candidates, {}, {}, chunkSize, result)) {
+        return {};
+    }
+
+    for (const auto& candidate : qAsConst(candidates)) {
+        cacheAvailability(availabilityCacheKey(tTable, tColumn, candidate), result.value(candidate));
+    }
+
+    return result;
+}
+
 bool IzSQLUtilities::SQLFunctions::objectNameAvailableWithConstrain(const QString& table, const QString& column, const QString& object, const QString& type, int typeID)
 {
     QString tTable = sanitize(table);
     QString tColumn = sanitize(column);
-    QString tObject = sanitize(object);
     QString tType = sanitize(type);
 
     SqlConnector db(m_databaseType, m_connectionParameters);
 
-    // TODO: uzupełnić o query.bindValue()
     if (db.getConnection().isOpen()) {
         QSqlQuery query(db.getConnection());
-        query.prepare(QStringLiteral("SELECT COUNT(id) FROM ") + tTable + QStringLiteral(" WHERE ") + tColumn + QStringLiteral(" = '") + tObject + QStringLiteral("' AND ") + tType + QStringLiteral(" = ") + QString::number(typeID));
+        query.prepare(QStringLiteral("SELECT COUNT(id) FROM ") + tTable + QStringLiteral(" WHERE ") + tColumn + QStringLiteral(" = :object AND ") + tType + QStringLiteral(" = :typeID"));
+        query.bindValue(QStringLiteral(":object"), object);
+        query.bindValue(QStringLiteral(":typeID"), typeID);
 
         if (query.exec()) {
             query.first();
@@ -204,6 +494,89 @@ bool IzSQLUtilities::SQLFunctions::objectNameAvailableWithConstrain(const QStrin
     return false;
 }
 
+QHash<QString, bool> IzSQLUtilities::SQLFunctions::objectNamesAvailableWithConstrain(const QString& table, const QString& column, const QStringList& objects, const QString& type, int typeID, int chunkSize)
+{
+    if (chunkSize <= 0) {
+        qCritical() << "Got invalid chunk size:" << chunkSize;
+        return {};
+    }
+
+    QString tTable = sanitize(table);
+    QString tColumn = sanitize(column);
+    QString tType = sanitize(type);
+
+    QHash<QString, bool> result;
+    QStringList candidates;
+    for (const auto& object : objects) {
+        if (!result.contains(object)) {
+            result.insert(object, true);
+            candidates.append(object);
+        }
+    }
+
+    if (candidates.isEmpty()) {
+        return result;
+    }
+
+    if (!queryAvailability(tTable, tColumn, candidates, tType + QStringLiteral(" = ?"), { typeID }, chunkSize, result)) {
+        return {};
+    }
+
+    return result;
+}
+
+bool IzSQLUtilities::SQLFunctions::queryAvailability(const QString& table, const QString& column, const QStringList& candidates, const QString& condition, const QVariantList& conditionValues, int chunkSize, QHash<QString, bool>& result) const
+{
+    SqlConnector db(m_databaseType, m_connectionParameters);
+    if (!db.getConnection().isOpen()) {
+        SQLErrorEvent::postSQLError(db.lastError());
+        return false;
+    }
+
+    // server answers for every candidate, in candidate order - no client side comparison of returned values
+    QString exists = QStringLiteral("CASE WHEN EXISTS (SELECT 1 FROM ") + table + QStringLiteral(" WHERE ") + column + QStringLiteral(" = ?");
+    if (!condition.isEmpty()) {
+        exists += QStringLiteral(" AND ") + condition;
+    }
+    exists += QStringLiteral(") THEN 1 ELSE 0 END");
+
+    QSqlQuery query(db.getConnection());
+    query.setForwardOnly(true);
+
+    int preparedSize{ -1 };
+    for (int offset = 0; offset < candidates.size(); offset += chunkSize) {
+        const int count = std::min(chunkSize, static_cast<int>(candidates.size()) - offset);
+
+        // statement is prepared again only for the last, shorter chunk
+        if (count != preparedSize) {
+            QStringList columns;
+            columns.fill(exists, count);
+            query.prepare(QStringLiteral("SELECT ") + columns.join(QStringLiteral(", ")));
+            preparedSize = count;
+        }
+
+        int position{ 0 };
+        for (int i = 0; i < count; ++i) {
+            query.bindValue(position++, candidates[offset + i]);
+            for (const auto& value : conditionValues) {
+                query.bindValue(position++, value);
+            }
+        }
+
+        if (!query.exec() || !query.next()) {
+            qCritical() << query.lastError().text();
+            SQLErrorEvent::postSQLError(query.lastError());
+            return false;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            result.insert(candidates[offset + i], query.value(i).toInt() == 0);
+        }
+    }
+
+    return true;
+}
+
 QString IzSQLUtilities::SQLFunctions::sanitize(const QString& parameter) const
 {
     QString out = parameter;
@@ -224,6 +597,69 @@ QString IzSQLUtilities::SQLFunctions::sanitize(const QString& parameter) const
     return out;
 }
 
+QString IzSQLUtilities::SQLFunctions::availabilityCacheKey(const QString& table, const QString& column, const QString& object) const
+{
+    return table + QLatin1Char('\x1f') + column + QLatin1Char('\x1f') + object;
+}
+
+bool IzSQLUtilities::SQLFunctions::cachedAvailability(const QString& key, bool& available)
+{
+    if (m_availabilityCacheTimeout <= 0) {
+        return false;
+    }
+
+    auto it = m_availabilityCache.find(key);
+    if (it == m_availabilityCache.end()) {
+        return false;
+    }
+
+    if (it->deadline.hasExpired()) {
+        m_availabilityCache.erase(it);
+        return false;
+    }
+
+    available = it->available;
+    return true;
+}
+
+void IzSQLUtilities::SQLFunctions::cacheAvailability(const QString& key, bool available)
+{
+    if (m_availabilityCacheTimeout <= 0) {
+        return;
+    }
+
+    if (m_availabilityCache.size() >= m_availabilityPruneSize) {
+        for (auto it = m_availabilityCache.begin(); it != m_availabilityCache.end();) {
+            if (it->deadline.hasExpired()) {
+                it = m_availabilityCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        m_availabilityPruneSize = std::max<qsizetype>(256, m_availabilityCache.size() * 2);
+    }
+
+    m_availabilityCache.insert(key, { available, QDeadlineTimer(m_availabilityCacheTimeout) });
+}
+
+int IzSQLUtilities::SQLFunctions::availabilityCacheTimeout() const
+{
+    return m_availabilityCacheTimeout;
+}
+
+void IzSQLUtilities::SQLFunctions::setAvailabilityCacheTimeout(int availabilityCacheTimeout)
+{
+    if (m_availabilityCacheTimeout != availabilityCacheTimeout) {
+        m_availabilityCacheTimeout = availabilityCacheTimeout;
+        m_availabilityCache.clear();
+    }
+}
+
+void IzSQLUtilities::SQLFunctions::clearAvailabilityCache()
+{
+    m_availabilityCache.clear();
+}
+
 IzSQLUtilities::DatabaseType IzSQLUtilities::SQLFunctions::databaseType() const
 {
     return m_databaseType;
@@ -233,6 +669,7 @@ void IzSQLUtilities::SQLFunctions::setDatabaseType(const IzSQLUtilities::Databas
 {
     if (m_databaseType != databaseType) {
         m_databaseType = databaseType;
+        m_availabilityCache.clear();
     }
 }
 
@@ -245,5 +682,6 @@ void IzSQLUtilities::SQLFunctions::setConnectionParameters(const QVariantMap& co
 {
     if (m_connectionParameters != connectionParameters) {
         m_connectionParameters = connectionParameters;
+        m_availabilityCache.clear();
     }
 }
@@ -50,7 +50,7 @@ bool IzSQLUtilities::SQLListModel::setData(const QModelIndex& index, const QVari
     // 'normal' role
     if (data(index, role) != value) {
         emit dataAboutToBeChanged(index, index, { role });
-        auto res = internalData()[index.row()]->setColumnValue(roleNameToColumn(roleToRoleName(role)), value);
+        auto res = detachRow(index.row()).setColumnValue(roleNameToColumn(roleToRoleName(role)), value);
 
         if (res) {
             emit dataChanged(index, index, { role });
@@ -65,6 +65,11 @@ bool IzSQLUtilities::SQLListModel::setData(const QModelIndex& index, const QVari
 void IzSQLUtilities::SQLListModel::additionalDataParsing(bool dataRefreshSucceeded)
 {
     if (dataRefreshSucceeded) {
+        // same column layout - cached role names are still valid
+        if (!schemaChanged()) {
+            return;
+        }
+
         QHash<int, QByteArray> rn;
         QMapIterator<int, QString> it(indexColumnMap());
 
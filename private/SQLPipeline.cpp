@@ -0,0 +1,215 @@
+﻿#include "IzSQLUtilities/SQLPipeline.h"
+
+#include <memory>
+
+#include <QDebug>
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtConcurrent>
+
+#include "IzSQLUtilities/SQLConnectionPool.h"
+#include "IzSQLUtilities/SQLConnector.h"
+#include "IzSQLUtilities/SQLErrorEvent.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
+
+IzSQLUtilities::SQLPipeline::SQLPipeline(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void IzSQLUtilities::SQLPipeline::enqueue(const QString& functionName, const QString& sqlDefinition, const QVariantMap& parameters)
+{
+    if (m_isRunning) {
+        qCritical() << "Cannot enqueue call:" << functionName << "- pipeline is currently executing.";
+        return;
+    }
+
+    if (sqlDefinition.isEmpty()) {
+        qCritical() << "Cannot enqueue call:" << functionName << "- sql definition is empty.";
+        return;
+    }
+
+    m_calls.push_back({ functionName, sqlDefinition, parameters });
+    emit countChanged();
+}
+
+void IzSQLUtilities::SQLPipeline::clear()
+{
+    if (m_isRunning) {
+        qCritical() << "Cannot clear pipeline - pipeline is currently executing.";
+        return;
+    }
+
+    m_calls.clear();
+    emit countChanged();
+}
+
+bool IzSQLUtilities::SQLPipeline::exec()
+{
+    if (m_isRunning) {
+        qCritical() << "Pipeline is already executing.";
+        return false;
+    }
+
+    setIsRunning(true);
+
+    SqlConnector db(m_databaseType, m_connectionParameters);
+    if (!db.getConnection().isOpen()) {
+        SQLErrorEvent::postSQLError(db.lastError());
+        return onExecuted({ false, {}, db.lastError().text() });
+    }
+
+    QSqlDatabase database = db.getConnection();
+    return onExecuted(execCalls(database, m_calls));
+}
+
+QFuture<bool> IzSQLUtilities::SQLPipeline::execAsync()
+{
+    if (m_isRunning) {
+        qCritical() << "Pipeline is already executing.";
+        return QtFuture::makeReadyFuture(false);
+    }
+
+    setIsRunning(true);
+
+    auto task = [databaseType = m_databaseType, connectionParameters = m_connectionParameters, calls = m_calls]() -> Result {
+        auto db = SQLConnectionPool::connection(databaseType, connectionParameters);
+        if (!db->getConnection().isOpen()) {
+            SQLErrorEvent::postSQLError(db->lastError());
+            return { false, {}, db->lastError().text() };
+        }
+
+        QSqlDatabase database = db->getConnection();
+        const Result result = execCalls(database, calls);
+
+        // broken connections are not reused
+        if (result.connectionLost) {
+            SQLConnectionPool::releaseConnection(databaseType, connectionParameters);
+        }
+
+        return result;
+    };
+
+    return QtConcurrent::run(SQLThreadPool::instance(), task).then(this, [this](const Result& result) -> bool {
+        return onExecuted(result);
+    });
+}
+
+IzSQLUtilities::SQLPipeline::Result IzSQLUtilities::SQLPipeline::execCalls(QSqlDatabase& database, const std::vector<Call>& calls)
+{
+    if (!database.transaction()) {
+        SQLErrorEvent::postSQLError(database.lastError());
+        return { false, {}, database.lastError().text(), database.lastError().type() == QSqlError::ConnectionError };
+    }
+
+    Result result{ true, {}, {} };
+    {
+        // prepared statements - reused across calls with identical sql
+        QHash<QString, std::shared_ptr<QSqlQuery>> statements;
+
+        for (const auto& call : calls) {
+            auto it = statements.find(call.sqlDefinition);
+            if (it == statements.end()) {
+                auto statement = std::make_shared<QSqlQuery>(database);
+                if (!statement->prepare(call.sqlDefinition)) {
+                    result = { false, call.functionName, statement->lastError().text(), statement->lastError().type() == QSqlError::ConnectionError };
+                    SQLErrorEvent::postSQLError(statement->lastError());
+                    break;
+                }
+                it = statements.insert(call.sqlDefinition, statement);
+            }
+
+            QSqlQuery& query = *it.value();
+
+            // values of the previous call are cleared - parameters omitted by this call are bound as NULL
+            const auto boundValues = query.boundValues().size();
+            for (qsizetype b = 0; b < boundValues; ++b) {
+                query.bindValue(static_cast<int>(b), QVariant());
+            }
+
+            QMapIterator<QString, QVariant> i(call.parameters);
+            while (i.hasNext()) {
+                i.next();
+                query.bindValue(QStringLiteral(":") + i.key(), i.value());
+            }
+
+            if (!query.exec()) {
+                result = { false, call.functionName, query.lastError().text(), query.lastError().type() == QSqlError::ConnectionError };
+                SQLErrorEvent::postSQLError(query.lastError());
+                break;
+            }
+            query.finish();
+        }
+    }
+
+    if (result.succeeded && database.commit()) {
+        return result;
+    }
+
+    if (result.succeeded) {
+        result = { false, QStringLiteral("COMMIT"), database.lastError().text(), database.lastError().type() == QSqlError::ConnectionError };
+        SQLErrorEvent::postSQLError(database.lastError());
+    }
+    database.rollback();
+
+    return result;
+}
+
+bool IzSQLUtilities::SQLPipeline::onExecuted(const Result& result)
+{
+    if (result.succeeded) {
+        qInfo() << "Pipeline of" << m_calls.size() << "calls executed.";
+        m_calls.clear();
+        emit countChanged();
+    } else {
+        qCritical() << "Pipeline failed on call:" << result.failedOperation << "-" << result.error << "- all calls were rolled back.";
+    }
+
+    setIsRunning(false);
+    emit finished(result.succeeded, result.failedOperation, result.error);
+
+    return result.succeeded;
+}
+
+int IzSQLUtilities::SQLPipeline::count() const
+{
+    return static_cast<int>(m_calls.size());
+}
+
+bool IzSQLUtilities::SQLPipeline::isRunning() const
+{
+    return m_isRunning;
+}
+
+void IzSQLUtilities::SQLPipeline::setIsRunning(bool isRunning)
+{
+    if (m_isRunning != isRunning) {
+        m_isRunning = isRunning;
+        emit isRunningChanged();
+    }
+}
+
+QVariantMap IzSQLUtilities::SQLPipeline::connectionParameters() const
+{
+    return m_connectionParameters;
+}
+
+void IzSQLUtilities::SQLPipeline::setConnectionParameters(const QVariantMap& connectionParameters)
+{
+    if (m_connectionParameters != connectionParameters) {
+        m_connectionParameters = connectionParameters;
+    }
+}
+
+IzSQLUtilities::DatabaseType IzSQLUtilities::SQLPipeline::databaseType() const
+{
+    return m_databaseType;
+}
+
+void IzSQLUtilities::SQLPipeline::setDatabaseType(const IzSQLUtilities::DatabaseType& databaseType)
+{
+    if (m_databaseType != databaseType) {
+        m_databaseType = databaseType;
+    }
+}
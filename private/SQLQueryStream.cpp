@@ -0,0 +1,115 @@
+﻿#include "IzSQLUtilities/SQLQueryStream.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+#include "IzSQLUtilities/SQLConnector.h"
+#include "IzSQLUtilities/SQLErrorEvent.h"
+
+IzSQLUtilities::SQLQueryStream::SQLQueryStream(const QString& sqlDefinition, const QVariantMap& parameters, int batchSize, DatabaseType databaseType, const QVariantMap& connectionParameters)
+    : m_sqlDefinition(sqlDefinition)
+    , m_parameters(parameters)
+    , m_batchSize(std::max(batchSize, 1))
+    , m_databaseType(databaseType)
+    , m_connectionParameters(connectionParameters)
+{
+}
+
+IzSQLUtilities::SQLQueryStream::~SQLQueryStream() = default;
+
+bool IzSQLUtilities::SQLQueryStream::exec()
+{
+    m_query.reset();
+    m_fetchedRows = 0;
+
+    // pooled connection of the thread would be shared by nested streams
+    m_connection = std::make_unique<SqlConnector>(m_databaseType, m_connectionParameters);
+    if (!m_connection->getConnection().isOpen()) {
+        m_lastError = m_connection->lastError();
+        SQLErrorEvent::postSQLError(m_lastError);
+        m_connection.reset();
+        return false;
+    }
+
+    m_query = std::make_unique<QSqlQuery>(m_connection->getConnection());
+    m_query->setForwardOnly(true);
+    m_query->prepare(m_sqlDefinition);
+
+    QMapIterator<QString, QVariant> it(m_parameters);
+    while (it.hasNext()) {
+        it.next();
+        m_query->bindValue(QStringLiteral(":") + it.key(), it.value());
+    }
+
+    if (!m_query->exec()) {
+        m_lastError = m_query->lastError();
+        qWarning() << m_lastError;
+        SQLErrorEvent::postSQLError(m_lastError);
+        m_query.reset();
+        m_connection.reset();
+        return false;
+    }
+
+    const QSqlRecord record = m_query->record();
+    QStringList columnNames;
+    columnNames.reserve(record.count());
+    for (int i = 0; i < record.count(); ++i) {
+        columnNames.append(record.fieldName(i));
+    }
+    m_batch.reset(columnNames, m_batchSize);
+
+    return true;
+}
+
+bool IzSQLUtilities::SQLQueryStream::next()
+{
+    if (!m_query) {
+        return false;
+    }
+
+    const int columnCount = m_batch.columnCount();
+    int rows{ 0 };
+
+    while (rows < m_batchSize && m_query->next()) {
+        for (int c = 0; c < columnCount; ++c) {
+            m_batch.value(rows, c) = m_query->value(c);
+        }
+        rows++;
+    }
+    m_batch.setRowCount(rows);
+    m_fetchedRows += rows;
+
+    if (m_query->lastError().isValid()) {
+        m_lastError = m_query->lastError();
+        SQLErrorEvent::postSQLError(m_lastError);
+        m_query.reset();
+        m_connection.reset();
+        return false;
+    }
+
+    // cursor exhausted - connection is not needed anymore
+    if (rows < m_batchSize) {
+        m_query.reset();
+        m_connection.reset();
+    }
+
+    return rows > 0;
+}
+
+const IzSQLUtilities::SQLRowBatch& IzSQLUtilities::SQLQueryStream::batch() const
+{
+    return m_batch;
+}
+
+qint64 IzSQLUtilities::SQLQueryStream::fetchedRows() const
+{
+    return m_fetchedRows;
+}
+
+QSqlError IzSQLUtilities::SQLQueryStream::lastError() const
+{
+    return m_lastError;
+}
@@ -0,0 +1,186 @@
+﻿#include "SQLQueryTemplate.h"
+
+#include <algorithm>
+
+#include <QHash>
+#include <QMutex>
+
+namespace
+{
+    // maximum number of cached templates
+    constexpr int maxCachedTemplates{ 256 };
+
+    // returns true if given character can be part of a keyword
+    bool isWordCharacter(QChar character)
+    {
+        return character.isLetterOrNumber() || character == QLatin1Char('_');
+    }
+}   // namespace
+
+IzSQLUtilities::SQLQueryTemplate::SQLQueryTemplate(const QString& sqlQuery)
+    : m_sqlQuery(sqlQuery)
+{
+    const int queryStringSize = static_cast<int>(sqlQuery.size());
+    int delimiterStart{ -1 };
+    int copiedUpTo{ 0 };
+
+    m_normalizedQuery.reserve(queryStringSize);
+
+    for (int i = 0; i < queryStringSize; ++i) {
+        if (sqlQuery[i] == QLatin1Char('\'') && i < queryStringSize - 1 && sqlQuery[i + 1] == QLatin1Char(':')) {
+            delimiterStart = i;
+        } else if (delimiterStart != -1 && sqlQuery[i] == QLatin1Char('\'')) {
+            m_parameters.append(sqlQuery.mid(delimiterStart + 1, i - delimiterStart - 1));
+            m_positions.push_back(delimiterStart);
+
+            m_normalizedQuery += QStringView(sqlQuery).mid(copiedUpTo, delimiterStart - copiedUpTo);
+            m_normalizedQuery += m_parameters.constLast();
+            copiedUpTo = i + 1;
+
+            delimiterStart = -1;
+        }
+    }
+
+    m_normalizedQuery += QStringView(sqlQuery).mid(copiedUpTo);
+    m_unterminatedDelimiter = delimiterStart;
+}
+
+std::shared_ptr<const IzSQLUtilities::SQLQueryTemplate> IzSQLUtilities::SQLQueryTemplate::compile(const QString& sqlQuery)
+{
+    if (sqlQuery.isEmpty()) {
+        return empty();
+    }
+
+    static QMutex mutex;
+    static QHash<QString, std::shared_ptr<const SQLQueryTemplate>> templates;
+
+    QMutexLocker locker(&mutex);
+
+    auto it = templates.constFind(sqlQuery);
+    if (it != templates.cend()) {
+        return it.value();
+    }
+
+    if (templates.size() >= maxCachedTemplates) {
+        templates.clear();
+    }
+
+    auto queryTemplate = std::make_shared<const SQLQueryTemplate>(sqlQuery);
+    templates.insert(sqlQuery, queryTemplate);
+
+    return queryTemplate;
+}
+
+std::shared_ptr<const IzSQLUtilities::SQLQueryTemplate> IzSQLUtilities::SQLQueryTemplate::empty()
+{
+    static const auto queryTemplate = std::make_shared<const SQLQueryTemplate>();
+    return queryTemplate;
+}
+
+QString IzSQLUtilities::SQLQueryTemplate::wrappable(const QString& sqlQuery)
+{
+    QString query = sqlQuery.trimmed();
+    while (query.endsWith(QLatin1Char(';'))) {
+        query.chop(1);
+        query = query.trimmed();
+    }
+
+    return query;
+}
+
+bool IzSQLUtilities::SQLQueryTemplate::hasOrderBy(const QString& sqlQuery)
+{
+    const QStringView query(sqlQuery);
+    const int size = static_cast<int>(query.size());
+    int depth{ 0 };
+
+    for (int i = 0; i < size; ++i) {
+        const QChar character = query[i];
+
+        // literals, quoted identifiers and comments are skipped - unterminated one ends the query
+        if (character == QLatin1Char('\'') || character == QLatin1Char('"') || character == QLatin1Char('`') || character == QLatin1Char('[')) {
+            const QChar closing = character == QLatin1Char('[') ? QLatin1Char(']') : character;
+            const auto end = query.indexOf(closing, i + 1);
+            if (end == -1) {
+                return false;
+            }
+            i = static_cast<int>(end);
+        } else if (character == QLatin1Char('-') && query.mid(i, 2) == QLatin1String("--")) {
+            const auto end = query.indexOf(QLatin1Char('\n'), i);
+            if (end == -1) {
+                return false;
+            }
+            i = static_cast<int>(end);
+        } else if (character == QLatin1Char('/') && query.mid(i, 2) == QLatin1String("/*")) {
+            const auto end = query.indexOf(QLatin1String("*/"), i + 2);
+            if (end == -1) {
+                return false;
+            }
+            i = static_cast<int>(end) + 1;
+        } else if (character == QLatin1Char('(')) {
+            depth++;
+        } else if (character == QLatin1Char(')')) {
+            depth--;
+        } else if (depth == 0 && (i == 0 || !isWordCharacter(query[i - 1])) && query.mid(i, 5).compare(QLatin1String("ORDER"), Qt::CaseInsensitive) == 0) {
+            int next = i + 5;
+            if (next >= size || !query[next].isSpace()) {
+                continue;
+            }
+
+            while (next < size && query[next].isSpace()) {
+                ++next;
+            }
+
+            if (query.mid(next, 2).compare(QLatin1String("BY"), Qt::CaseInsensitive) == 0 && (next + 2 >= size || !isWordCharacter(query[next + 2]))) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+const QString& IzSQLUtilities::SQLQueryTemplate::sqlQuery() const
+{
+    return m_sqlQuery;
+}
+
+const QStringList& IzSQLUtilities::SQLQueryTemplate::parameters() const
+{
+    return m_parameters;
+}
+
+int IzSQLUtilities::SQLQueryTemplate::unterminatedDelimiter() const
+{
+    return m_unterminatedDelimiter;
+}
+
+QString IzSQLUtilities::SQLQueryTemplate::normalizedQuery(const QVariantMap& sqlParameters) const
+{
+    // valid queries have all of their parameters passed
+    const bool allPassed = std::all_of(m_parameters.cbegin(), m_parameters.cend(), [&sqlParameters](const QString& parameter) {
+        return sqlParameters.contains(parameter);
+    });
+
+    if (allPassed) {
+        return m_normalizedQuery;
+    }
+
+    QString query;
+    query.reserve(m_sqlQuery.size());
+
+    int copiedUpTo{ 0 };
+    for (std::size_t i = 0; i < m_positions.size(); ++i) {
+        const QString& parameter = m_parameters.at(static_cast<qsizetype>(i));
+        if (!sqlParameters.contains(parameter)) {
+            continue;
+        }
+
+        query += QStringView(m_sqlQuery).mid(copiedUpTo, m_positions[i] - copiedUpTo);
+        query += parameter;
+        copiedUpTo = m_positions[i] + static_cast<int>(parameter.size()) + 2;
+    }
+    query += QStringView(m_sqlQuery).mid(copiedUpTo);
+
+    return query;
+}
@@ -0,0 +1,67 @@
+﻿#ifndef IZSQLUTILITIES_SQLQUERYTEMPLATE_H
+#define IZSQLUTILITIES_SQLQUERYTEMPLATE_H
+
+#include <memory>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+namespace IzSQLUtilities
+{
+    // immutable, parsed sql query with quoted parameters: ':parameter'
+    // query text is scanned once - validation and normalization of its parameters do not touch the text again
+    class SQLQueryTemplate
+    {
+    public:
+        // ctor - empty query
+        SQLQueryTemplate() = default;
+
+        // ctor - parses given query
+        explicit SQLQueryTemplate(const QString& sqlQuery);
+
+        // returns template of given query, reusing the one cached for the same query text
+        static std::shared_ptr<const SQLQueryTemplate> compile(const QString& sqlQuery);
+
+        // returns shared template of empty query
+        static std::shared_ptr<const SQLQueryTemplate> empty();
+
+        // returns given query without trailing semicolons, so it can be wrapped as a subquery
+        static QString wrappable(const QString& sqlQuery);
+
+        // returns true if given query has ORDER BY at its top level - such query can not be wrapped as a subquery on MSSQL and loses its order elsewhere
+        static bool hasOrderBy(const QString& sqlQuery);
+
+        // returns parsed query
+        const QString& sqlQuery() const;
+
+        // returns names of quoted parameters, in order of their occurrence
+        const QStringList& parameters() const;
+
+        // returns position of unterminated parameter delimiter or -1
+        int unterminatedDelimiter() const;
+
+        // returns query with given parameters unquoted: ':parameter' -> :parameter
+        // parameters missing from sqlParameters stay quoted
+        QString normalizedQuery(const QVariantMap& sqlParameters) const;
+
+    private:
+        // parsed query
+        QString m_sqlQuery;
+
+        // query with all parameters unquoted
+        QString m_normalizedQuery;
+
+        // names of quoted parameters
+        QStringList m_parameters;
+
+        // positions of opening delimiters of m_parameters
+        std::vector<int> m_positions;
+
+        // position of unterminated parameter delimiter
+        int m_unterminatedDelimiter{ -1 };
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLQUERYTEMPLATE_H
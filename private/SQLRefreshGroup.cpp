@@ -0,0 +1,393 @@
+﻿#include "IzSQLUtilities/SQLRefreshGroup.h"
+
+#include <vector>
+
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+#include "IzSQLUtilities/AbstractSQLModel.h"
+#include "IzSQLUtilities/SQLConnectionPool.h"
+#include "IzSQLUtilities/SQLConnector.h"
+#include "IzSQLUtilities/SQLErrorEvent.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
+
+#include "SQLQueryTemplate.h"
+
+namespace
+{
+    // query of single model of the group
+    struct GroupMember {
+        // loaded model
+        IzSQLUtilities::AbstractSQLModel* model;
+
+        // normalized query of the model
+        QString sqlQuery;
+
+        // parameters of the query
+        QVariantMap sqlParameters;
+    };
+
+    // executes given query with given parameters, posting its error
+    bool execQuery(QSqlQuery& query, const QString& sqlQuery, const QVariantMap& sqlParameters)
+    {
+        query.setForwardOnly(true);
+        query.prepare(sqlQuery);
+
+        QMapIterator<QString, QVariant> it(sqlParameters);
+        while (it.hasNext()) {
+            it.next();
+            query.bindValue(it.key(), it.value());
+        }
+
+        if (!query.exec()) {
+            qWarning() << query.lastError();
+            IzSQLUtilities::SQLErrorEvent::postSQLError(query.lastError());
+            return false;
+        }
+
+        return true;
+    }
+
+    // executes given statement, posting its error
+    bool execStatement(QSqlDatabase& database, const QString& statement)
+    {
+        QSqlQuery query(database);
+        if (!query.exec(statement)) {
+            qWarning() << query.lastError();
+            IzSQLUtilities::SQLErrorEvent::postSQLError(query.lastError());
+            return false;
+        }
+
+        return true;
+    }
+
+    // starts transaction which sees one snapshot of the data - PSQL one is read only if requested
+    bool beginSnapshot(QSqlDatabase& database, IzSQLUtilities::DatabaseType databaseType, bool readOnly)
+    {
+        // isolation of MSSQL is set for the session, before transaction starts
+        if (databaseType == IzSQLUtilities::DatabaseType::MSSQL && !execStatement(database, QStringLiteral("SET TRANSACTION ISOLATION LEVEL SNAPSHOT"))) {
+            return false;
+        }
+
+        if (!database.transaction()) {
+            IzSQLUtilities::SQLErrorEvent::postSQLError(database.lastError());
+            if (databaseType == IzSQLUtilities::DatabaseType::MSSQL) {
+                execStatement(database, QStringLiteral("SET TRANSACTION ISOLATION LEVEL READ COMMITTED"));
+            }
+            return false;
+        }
+
+        // isolation of PSQL is set by the first statement of transaction
+        // SQLITE transaction reads one snapshot from its first read on
+        if (databaseType == IzSQLUtilities::DatabaseType::PSQL
+            && !execStatement(database, readOnly ? QStringLiteral("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ READ ONLY") : QStringLiteral("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ"))) {
+            database.rollback();
+            return false;
+        }
+
+        return true;
+    }
+
+    // ends transaction started by beginSnapshot() - pooled connection is left in its default state
+    void endSnapshot(QSqlDatabase& database, IzSQLUtilities::DatabaseType databaseType, bool succeeded)
+    {
+        if (!succeeded || !database.commit()) {
+            database.rollback();
+        }
+
+        if (databaseType == IzSQLUtilities::DatabaseType::MSSQL) {
+            execStatement(database, QStringLiteral("SET TRANSACTION ISOLATION LEVEL READ COMMITTED"));
+        }
+    }
+}   // namespace
+
+IzSQLUtilities::SQLRefreshGroup::SQLRefreshGroup(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void IzSQLUtilities::SQLRefreshGroup::addModel(AbstractSQLModel* model)
+{
+    if (model == nullptr) {
+        qCritical() << "Got invalid model to add to the refresh group.";
+        return;
+    }
+
+    // rows loaded on demand can not be filled from the group's results
+    if (!model->holdsAllRows()) {
+        qCritical() << "Cannot add model - it loads its rows on demand.";
+        return;
+    }
+
+    if (m_isRefreshing) {
+        qCritical() << "Cannot add model - refresh group is currently refreshing.";
+        return;
+    }
+
+    if (!m_models.contains(model)) {
+        m_models.append(model);
+        emit countChanged();
+    }
+}
+
+void IzSQLUtilities::SQLRefreshGroup::removeModel(AbstractSQLModel* model)
+{
+    if (m_isRefreshing) {
+        qCritical() << "Cannot remove model - refresh group is currently refreshing.";
+        return;
+    }
+
+    if (m_models.removeAll(model) > 0) {
+        emit countChanged();
+    }
+}
+
+void IzSQLUtilities::SQLRefreshGroup::clear()
+{
+    if (m_isRefreshing) {
+        qCritical() << "Cannot clear refresh group - group is currently refreshing.";
+        return;
+    }
+
+    m_models.clear();
+    emit countChanged();
+}
+
+bool IzSQLUtilities::SQLRefreshGroup::refresh()
+{
+    if (m_isRefreshing) {
+        qCritical() << "Refresh group is already refreshing.";
+        return false;
+    }
+
+    // removes models destroyed in the meantime
+    if (m_models.removeIf([](const auto& model) { return model.isNull(); }) > 0) {
+        emit countChanged();
+    }
+
+    if (m_models.isEmpty()) {
+        qCritical() << "Refresh group has no models to refresh.";
+        return false;
+    }
+
+    const auto databaseType = m_models.constFirst()->m_databaseType;
+    const auto connectionParameters = m_models.constFirst()->m_connectionParameters;
+    const QString target = SQLThreadPool::target(databaseType, connectionParameters);
+
+    // group is refreshed all or nothing - every model is checked before any of them starts
+    for (const auto& model : std::as_const(m_models)) {
+        if (model->isRefreshingData()) {
+            qCritical() << "Group refresh is not possible - model is still loading data.";
+            return false;
+        }
+
+        if (m_sqlQuery.isEmpty() && !model->queryIsValid()) {
+            qCritical() << "Group refresh is not possible - query of the model is invalid.";
+            return false;
+        }
+
+        if (SQLThreadPool::target(model->m_databaseType, model->m_connectionParameters) != target) {
+            qCritical() << "Group refresh is not possible - models use different databases.";
+            return false;
+        }
+    }
+
+    // batch query replaces queries of the models
+    const auto batchTemplate = SQLQueryTemplate::compile(m_sqlQuery);
+    if (!m_sqlQuery.isEmpty()) {
+        bool batchIsValid = batchTemplate->unterminatedDelimiter() == -1 && batchTemplate->parameters().size() == m_sqlQueryParameters.size();
+        for (const auto& parameter : batchTemplate->parameters()) {
+            batchIsValid = batchIsValid && m_sqlQueryParameters.contains(parameter);
+        }
+
+        if (!batchIsValid) {
+            qCritical() << "Group refresh is not possible - batch query or its parameters are invalid.";
+            return false;
+        }
+    }
+
+    std::vector<GroupMember> members;
+    members.reserve(static_cast<std::size_t>(m_models.size()));
+    for (const auto& model : std::as_const(m_models)) {
+        model->beginGroupRefresh();
+        members.push_back({ model.data(), model->m_queryTemplate->normalizedQuery(model->m_sqlQueryParameters), model->m_sqlQueryParameters });
+    }
+
+    setIsRefreshing(true);
+    emit refreshStarted();
+
+    auto task = [databaseType, connectionParameters, target, consistentSnapshot = m_consistentSnapshot, batchQuery = batchTemplate->normalizedQuery(m_sqlQueryParameters), batchParameters = m_sqlQueryParameters, members]() -> std::vector<AbstractSQLModel::LoadedData> {
+        std::vector<AbstractSQLModel::LoadedData> results;
+
+        auto db = SQLConnectionPool::connection(databaseType, connectionParameters);
+        if (!db->getConnection().isOpen()) {
+            SQLErrorEvent::postSQLError(db->lastError());
+            results.assign(members.size(), { AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            return results;
+        }
+
+        QSqlDatabase database = db->getConnection();
+        // batch procedures may write, e.g. into temporary tables - their transaction is not read only
+        if (consistentSnapshot && !beginSnapshot(database, databaseType, batchQuery.isEmpty())) {
+            results.assign(members.size(), { AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            return results;
+        }
+
+        // queries run back to back - first failure stops the remaining ones
+        bool succeeded{ true };
+        if (batchQuery.isEmpty()) {
+            for (const auto& member : members) {
+                if (!succeeded) {
+                    results.push_back({ AbstractSQLModel::DataRefreshResult::Aborted, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+                    continue;
+                }
+
+                results.push_back(member.model->loadData(database, member.sqlQuery, member.sqlParameters));
+                succeeded = std::get<0>(results.back()) == AbstractSQLModel::DataRefreshResult::Refreshed;
+            }
+        } else {
+            // batch is executed once, its result sets are read in order - one per model
+            QSqlQuery query(database);
+            succeeded = execQuery(query, batchQuery, batchParameters);
+            if (!succeeded) {
+                results.assign(members.size(), { AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            }
+
+            // moves to the next result set with columns - row counts of statements preceding the selects are skipped
+            const auto nextRowSet = [&query](bool first) {
+                if (!first && !query.nextResult()) {
+                    return false;
+                }
+
+                while (!query.isSelect() || query.record().isEmpty()) {
+                    if (!query.nextResult()) {
+                        return false;
+                    }
+                }
+
+                return true;
+            };
+
+            for (std::size_t i = 0; succeeded && i < members.size(); ++i) {
+                if (!nextRowSet(i == 0)) {
+                    qCritical() << "Batch query returned" << i << "result sets for" << members.size() << "models.";
+                    results.push_back({ AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+                    succeeded = false;
+                    break;
+                }
+
+                const QString resultKey = target + QLatin1Char('\x1e') + batchQuery + QLatin1Char('\x1e') + QString::number(i);
+                results.push_back(members[i].model->loadResult(query, resultKey));
+                succeeded = std::get<0>(results.back()) == AbstractSQLModel::DataRefreshResult::Refreshed;
+            }
+
+            results.resize(members.size(), { AbstractSQLModel::DataRefreshResult::Aborted, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() });
+            query.finish();
+        }
+
+        if (consistentSnapshot) {
+            endSnapshot(database, databaseType, succeeded);
+        }
+
+        // data of the group is applied all or nothing - loaded models keep their current data
+        if (!succeeded) {
+            for (auto& result : results) {
+                if (std::get<0>(result) == AbstractSQLModel::DataRefreshResult::Refreshed) {
+                    result = { AbstractSQLModel::DataRefreshResult::Aborted, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+                }
+            }
+        }
+
+        return results;
+    };
+
+    SQLThreadPool::run(target, SQLThreadPool::Priority::Interactive, std::move(task)).then(this, [this, models = m_models](const std::vector<AbstractSQLModel::LoadedData>& results) {
+        // every model is swapped in this call - views never show data of different snapshots
+        bool succeeded{ true };
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            succeeded = succeeded && std::get<0>(results[i]) == AbstractSQLModel::DataRefreshResult::Refreshed;
+
+            const auto& model = models.at(static_cast<qsizetype>(i));
+            if (!model.isNull()) {
+                model->applyRefreshResult(results[i]);
+            }
+        }
+
+        setIsRefreshing(false);
+        emit refreshEnded(succeeded);
+    });
+
+    return true;
+}
+
+void IzSQLUtilities::SQLRefreshGroup::abort()
+{
+    if (!m_isRefreshing) {
+        return;
+    }
+
+    for (const auto& model : std::as_const(m_models)) {
+        if (!model.isNull()) {
+            model->abortRefresh();
+        }
+    }
+}
+
+int IzSQLUtilities::SQLRefreshGroup::count() const
+{
+    return static_cast<int>(m_models.size());
+}
+
+bool IzSQLUtilities::SQLRefreshGroup::isRefreshing() const
+{
+    return m_isRefreshing;
+}
+
+void IzSQLUtilities::SQLRefreshGroup::setIsRefreshing(bool isRefreshing)
+{
+    if (m_isRefreshing != isRefreshing) {
+        m_isRefreshing = isRefreshing;
+        emit isRefreshingChanged();
+    }
+}
+
+bool IzSQLUtilities::SQLRefreshGroup::consistentSnapshot() const
+{
+    return m_consistentSnapshot;
+}
+
+void IzSQLUtilities::SQLRefreshGroup::setConsistentSnapshot(bool consistentSnapshot)
+{
+    if (m_consistentSnapshot != consistentSnapshot) {
+        m_consistentSnapshot = consistentSnapshot;
+        emit consistentSnapshotChanged();
+    }
+}
+
+QString IzSQLUtilities::SQLRefreshGroup::sqlQuery() const
+{
+    return m_sqlQuery;
+}
+
+void IzSQLUtilities::SQLRefreshGroup::setSqlQuery(const QString& sqlQuery)
+{
+    if (m_sqlQuery != sqlQuery) {
+        m_sqlQuery = sqlQuery;
+        emit sqlQueryChanged();
+    }
+}
+
+QVariantMap IzSQLUtilities::SQLRefreshGroup::sqlQueryParameters() const
+{
+    return m_sqlQueryParameters;
+}
+
+void IzSQLUtilities::SQLRefreshGroup::setSqlQueryParameters(const QVariantMap& sqlQueryParameters)
+{
+    if (m_sqlQueryParameters != sqlQueryParameters) {
+        m_sqlQueryParameters = sqlQueryParameters;
+        emit sqlQueryParametersChanged();
+    }
+}
@@ -0,0 +1,134 @@
+﻿#include "IzSQLUtilities/SQLRefreshScheduler.h"
+
+#include <QDebug>
+#include <QTimer>
+
+#include "IzSQLUtilities/AbstractSQLModel.h"
+
+IzSQLUtilities::SQLRefreshScheduler::SQLRefreshScheduler(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void IzSQLUtilities::SQLRefreshScheduler::schedule(AbstractSQLModel* model)
+{
+    if (model == nullptr) {
+        qCritical() << "Got invalid model to schedule refresh of.";
+        return;
+    }
+
+    if (!isPending(model)) {
+        m_pendingModels.append(model);
+    }
+
+    if (!m_connectedModels.contains(model)) {
+        m_connectedModels.insert(model);
+
+        // pending refresh starts when running one ends - queued, so model is no longer refreshing by then
+        // model may be destroyed before queued call is delivered
+        connect(
+            model, &AbstractSQLModel::dataRefreshEnded, this, [this, guardedModel = QPointer<AbstractSQLModel>(model)]() {
+                if (guardedModel.isNull()) {
+                    return;
+                }
+
+                auto timer = m_debounceTimers.value(guardedModel.data());
+                if (timer == nullptr || !timer->isActive()) {
+                    startPendingRefresh(guardedModel.data());
+                }
+            },
+            Qt::QueuedConnection);
+
+        connect(model, &QObject::destroyed, this, [this, model]() {
+            m_connectedModels.remove(model);
+            delete m_debounceTimers.take(model);
+        });
+    }
+
+    // requests for other models do not delay this one
+    debounceTimer(model)->start();
+}
+
+void IzSQLUtilities::SQLRefreshScheduler::cancel(AbstractSQLModel* model)
+{
+    m_pendingModels.removeAll(model);
+
+    if (auto timer = m_debounceTimers.value(model)) {
+        timer->stop();
+    }
+}
+
+bool IzSQLUtilities::SQLRefreshScheduler::isPending(AbstractSQLModel* model) const
+{
+    return m_pendingModels.contains(model);
+}
+
+int IzSQLUtilities::SQLRefreshScheduler::debounceInterval() const
+{
+    return m_debounceInterval;
+}
+
+void IzSQLUtilities::SQLRefreshScheduler::setDebounceInterval(int debounceInterval)
+{
+    if (m_debounceInterval != debounceInterval) {
+        m_debounceInterval = debounceInterval;
+        for (auto timer : std::as_const(m_debounceTimers)) {
+            timer->setInterval(debounceInterval);
+        }
+        emit debounceIntervalChanged();
+    }
+}
+
+bool IzSQLUtilities::SQLRefreshScheduler::abortRunning() const
+{
+    return m_abortRunning;
+}
+
+void IzSQLUtilities::SQLRefreshScheduler::setAbortRunning(bool abortRunning)
+{
+    if (m_abortRunning != abortRunning) {
+        m_abortRunning = abortRunning;
+        emit abortRunningChanged();
+    }
+}
+
+QTimer* IzSQLUtilities::SQLRefreshScheduler::debounceTimer(AbstractSQLModel* model)
+{
+    auto& timer = m_debounceTimers[model];
+    if (timer == nullptr) {
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        timer->setInterval(m_debounceInterval);
+
+        connect(timer, &QTimer::timeout, this, [this, guardedModel = QPointer<AbstractSQLModel>(model)]() {
+            // removes models destroyed in the meantime
+            m_pendingModels.removeIf([](const auto& pendingModel) { return pendingModel.isNull(); });
+            startPendingRefresh(guardedModel.data());
+        });
+    }
+    return timer;
+}
+
+void IzSQLUtilities::SQLRefreshScheduler::startPendingRefresh(AbstractSQLModel* model)
+{
+    if (model == nullptr || !isPending(model)) {
+        return;
+    }
+
+    // refresh stays pending until running one ends
+    if (model->isRefreshingData()) {
+        if (m_abortRunning) {
+            model->abortRefresh();
+        }
+        return;
+    }
+
+    m_pendingModels.removeAll(model);
+
+    // parameters may still be incomplete - next change of the query will schedule refresh again
+    if (!model->queryIsValid()) {
+        return;
+    }
+
+    model->refreshData();
+}
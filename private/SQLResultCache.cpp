@@ -0,0 +1,258 @@
+﻿#include "IzSQLUtilities/SQLResultCache.h"
+
+#include <atomic>
+
+#include <QDeadlineTimer>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QPromise>
+#include <QScopeGuard>
+
+#include "LoadedSQLData.h"
+
+namespace
+{
+    // cached query result
+    struct CacheEntry {
+        // shared data
+        std::shared_ptr<const IzSQLUtilities::LoadedSQLData> data;
+
+        // expiration of the entry
+        QDeadlineTimer expiration;
+
+        // approximate size of data
+        qint64 size{ 0 };
+
+        // value of use counter at last access
+        quint64 lastUse{ 0 };
+    };
+
+    // state of the cache
+    struct ResultCache {
+        QMutex mutex;
+
+        // key -> cached data
+        QHash<QString, CacheEntry> entries;
+
+        // key -> pending load
+        QHash<QString, QFuture<std::shared_ptr<const IzSQLUtilities::LoadedSQLData>>> pendingLoads;
+
+        // configuration
+        int timeToLive{ 60000 };
+        qint64 memoryBudget{ 64 * 1024 * 1024 };
+
+        // memory used by entries
+        qint64 usedMemory{ 0 };
+
+        // incremented on every entry access - used for LRU eviction
+        quint64 useCounter{ 0 };
+
+        // statistics
+        std::atomic<quint64> hits{ 0 };
+        std::atomic<quint64> misses{ 0 };
+        std::atomic<quint64> evictions{ 0 };
+    };
+
+    ResultCache& resultCache()
+    {
+        static ResultCache cache;
+        return cache;
+    }
+
+    // evicts least recently used entries until data fits in the budget - cache mutex has to be locked
+    void evictEntries(ResultCache& cache)
+    {
+        while (cache.usedMemory > cache.memoryBudget && !cache.entries.isEmpty()) {
+            auto lru = cache.entries.begin();
+            for (auto it = cache.entries.begin(); it != cache.entries.end(); ++it) {
+                if (it->lastUse < lru->lastUse) {
+                    lru = it;
+                }
+            }
+
+            cache.usedMemory -= lru->size;
+            cache.entries.erase(lru);
+            cache.evictions++;
+        }
+    }
+
+    // stores result of finished load and hands it to its waiters
+    void finishLoad(const QString& key, QPromise<std::shared_ptr<const IzSQLUtilities::LoadedSQLData>>& promise, const std::shared_ptr<const IzSQLUtilities::LoadedSQLData>& data)
+    {
+        auto& cache = resultCache();
+        {
+            QMutexLocker locker(&cache.mutex);
+            cache.pendingLoads.remove(key);
+
+            if (data && cache.timeToLive > 0) {
+                const qint64 size = data->estimatedSize();
+                if (size <= cache.memoryBudget) {
+                    cache.usedMemory += size;
+                    cache.entries.insert(key, { data, QDeadlineTimer(cache.timeToLive), size, ++cache.useCounter });
+                    evictEntries(cache);
+                }
+            }
+        }
+
+        promise.addResult(data);
+        promise.finish();
+    }
+}   // namespace
+
+QString IzSQLUtilities::SQLResultCache::key(const QString& sqlQuery, const QVariantMap& sqlParameters, DatabaseType databaseType, const QVariantMap& connectionParameters, const QVariantMap& loadOptions)
+{
+    QString key = QString::number(static_cast<int>(databaseType));
+
+    QMapIterator<QString, QVariant> it(connectionParameters);
+    while (it.hasNext()) {
+        it.next();
+        key += QLatin1Char('\x1f') + it.key() + QLatin1Char('=') + it.value().toString();
+    }
+
+    key += QLatin1Char('\x1e') + sqlQuery;
+
+    QMapIterator<QString, QVariant> pIt(sqlParameters);
+    while (pIt.hasNext()) {
+        pIt.next();
+        key += QLatin1Char('\x1f') + pIt.key() + QLatin1Char('=') + QLatin1String(pIt.value().typeName()) + QLatin1Char(':') + pIt.value().toString();
+    }
+
+    QMapIterator<QString, QVariant> tIt(loadOptions);
+    while (tIt.hasNext()) {
+        tIt.next();
+        key += QLatin1Char('\x1d') + tIt.key() + QLatin1Char('=') + tIt.value().toString();
+    }
+
+    return key;
+}
+
+QFuture<std::shared_ptr<const IzSQLUtilities::LoadedSQLData>> IzSQLUtilities::SQLResultCache::fetch(const QString& key, const Loader& loader)
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    // cached entry
+    auto it = cache.entries.find(key);
+    if (it != cache.entries.end()) {
+        if (!it->expiration.hasExpired()) {
+            it->lastUse = ++cache.useCounter;
+            cache.hits++;
+            return QtFuture::makeReadyFuture(it->data);
+        }
+
+        cache.usedMemory -= it->size;
+        cache.entries.erase(it);
+        cache.evictions++;
+    }
+
+    // pending load
+    auto pending = cache.pendingLoads.constFind(key);
+    if (pending != cache.pendingLoads.cend()) {
+        cache.hits++;
+        return pending.value();
+    }
+
+    // new load
+    cache.misses++;
+
+    auto promise = std::make_shared<QPromise<std::shared_ptr<const LoadedSQLData>>>();
+    promise->start();
+    auto future = promise->future();
+    cache.pendingLoads.insert(key, future);
+    locker.unlock();
+
+    // pending entry is removed and waiters get nullptr even if loader throws
+    auto pendingGuard = qScopeGuard([&key, &promise]() {
+        finishLoad(key, *promise, nullptr);
+    });
+    QFuture<std::shared_ptr<LoadedSQLData>> load = loader();
+    pendingGuard.dismiss();
+
+    // failed load leaves its future without result, cancelled one skips then()
+    load.then([key, promise](QFuture<std::shared_ptr<LoadedSQLData>> finished) {
+            finishLoad(key, *promise, finished.resultCount() > 0 ? finished.result() : nullptr);
+        })
+        .onCanceled([key, promise]() {
+            finishLoad(key, *promise, nullptr);
+        });
+
+    return future;
+}
+
+void IzSQLUtilities::SQLResultCache::remove(const QString& key)
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    auto it = cache.entries.find(key);
+    if (it != cache.entries.end()) {
+        cache.usedMemory -= it->size;
+        cache.entries.erase(it);
+    }
+}
+
+void IzSQLUtilities::SQLResultCache::clear()
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    cache.entries.clear();
+    cache.usedMemory = 0;
+}
+
+int IzSQLUtilities::SQLResultCache::timeToLive()
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    return cache.timeToLive;
+}
+
+void IzSQLUtilities::SQLResultCache::setTimeToLive(int timeToLive)
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    cache.timeToLive = timeToLive;
+}
+
+qint64 IzSQLUtilities::SQLResultCache::memoryBudget()
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    return cache.memoryBudget;
+}
+
+void IzSQLUtilities::SQLResultCache::setMemoryBudget(qint64 memoryBudget)
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    cache.memoryBudget = memoryBudget;
+    evictEntries(cache);
+}
+
+qint64 IzSQLUtilities::SQLResultCache::usedMemory()
+{
+    auto& cache = resultCache();
+    QMutexLocker locker(&cache.mutex);
+
+    return cache.usedMemory;
+}
+
+quint64 IzSQLUtilities::SQLResultCache::hits()
+{
+    return resultCache().hits;
+}
+
+quint64 IzSQLUtilities::SQLResultCache::misses()
+{
+    return resultCache().misses;
+}
+
+quint64 IzSQLUtilities::SQLResultCache::evictions()
+{
+    return resultCache().evictions;
+}
@@ -0,0 +1,177 @@
+﻿#ifndef IZSQLUTILITIES_SQLRINGBUFFER_H
+#define IZSQLUTILITIES_SQLRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace IzSQLUtilities
+{
+    // bounded, lock-free single producer / single consumer queue connecting stages of data load
+    // waiting side spins briefly, then yields and finally blocks until the other side makes progress
+    // values are passed without locking - the other side is woken only if it announced it is blocked
+    // WARNING: push() and close() can be called only by one thread, pop() only by one other thread
+    template<typename T>
+    class SQLRingBuffer
+    {
+    public:
+        // ctor - capacity is rounded up to the power of two
+        explicit SQLRingBuffer(std::size_t capacity)
+        {
+            std::size_t size{ 1 };
+            while (size < capacity) {
+                size <<= 1;
+            }
+
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        SQLRingBuffer(const SQLRingBuffer& other) = delete;
+        SQLRingBuffer(SQLRingBuffer&& other) = delete;
+
+        // moves value into the queue, returns false if the queue is full
+        bool tryPush(T&& value)
+        {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+                return false;
+            }
+
+            m_slots[tail & m_mask] = std::move(value);
+            m_tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // moves value into the queue, waiting for free slot
+        void push(T&& value)
+        {
+            for (int attempt = 0; !tryPush(std::move(value)); ++attempt) {
+                if (!backoff(attempt)) {
+                    wait(m_producerWaiting, m_notFull, [this]() {
+                        return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire) != m_slots.size();
+                    });
+                }
+            }
+
+            wake(m_consumerWaiting, m_notEmpty);
+        }
+
+        // marks end of the data - pop() returns false once remaining values are consumed
+        void close()
+        {
+            m_closed.store(true, std::memory_order_release);
+            wake(m_consumerWaiting, m_notEmpty);
+        }
+
+        // moves oldest value out of the queue, returns false if the queue is empty
+        bool tryPop(T& value)
+        {
+            const std::size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            value = std::move(m_slots[head & m_mask]);
+            m_head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // moves oldest value out of the queue, waiting for it - returns false if the queue was closed and is empty
+        bool pop(T& value)
+        {
+            for (int attempt = 0;; ++attempt) {
+                if (tryPop(value)) {
+                    wake(m_producerWaiting, m_notFull);
+                    return true;
+                }
+
+                // values pushed before close() are visible once closed flag is
+                if (m_closed.load(std::memory_order_acquire)) {
+                    return tryPop(value);
+                }
+
+                if (!backoff(attempt)) {
+                    wait(m_consumerWaiting, m_notEmpty, [this]() {
+                        return m_head.load(std::memory_order_relaxed) != m_tail.load(std::memory_order_acquire) || m_closed.load(std::memory_order_acquire);
+                    });
+                }
+            }
+        }
+
+    private:
+        // waits before next attempt - returns false once the caller should block instead
+        static bool backoff(int attempt)
+        {
+            if (attempt < 64) {
+                return true;
+            }
+
+            if (attempt < 128) {
+                QThread::yieldCurrentThread();
+                return true;
+            }
+
+            return false;
+        }
+
+        // blocks until given predicate holds - waiting flag is announced before the predicate is checked
+        template<typename Predicate>
+        void wait(std::atomic<bool>& waiting, QWaitCondition& condition, Predicate ready)
+        {
+            QMutexLocker locker(&m_waitMutex);
+            waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            while (!ready()) {
+                condition.wait(&m_waitMutex);
+            }
+
+            waiting.store(false, std::memory_order_relaxed);
+        }
+
+        // wakes the other side if it announced it is blocked - pairs with the fence in wait()
+        void wake(std::atomic<bool>& waiting, QWaitCondition& condition)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed)) {
+                QMutexLocker locker(&m_waitMutex);
+                condition.wakeOne();
+            }
+        }
+
+        // storage of queued values
+        std::vector<T> m_slots;
+
+        // m_slots.size() - 1
+        std::size_t m_mask{ 0 };
+
+        // position of the next value to pop - written only by consumer
+        alignas(64) std::atomic<std::size_t> m_head{ 0 };
+
+        // position of the next value to push - written only by producer
+        alignas(64) std::atomic<std::size_t> m_tail{ 0 };
+
+        // true once producer finished
+        std::atomic<bool> m_closed{ false };
+
+        // true while producer / consumer is blocked
+        std::atomic<bool> m_producerWaiting{ false };
+        std::atomic<bool> m_consumerWaiting{ false };
+
+        // guards blocking of both sides
+        QMutex m_waitMutex;
+
+        // signaled when a value is popped / pushed or the queue is closed
+        QWaitCondition m_notFull;
+        QWaitCondition m_notEmpty;
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLRINGBUFFER_H
@@ -1,5 +1,7 @@
 ﻿#include "IzSQLUtilities/SQLRow.h"
 
+#include <algorithm>
+
 #include <QDebug>
 
 IzSQLUtilities::SQLRow::SQLRow(std::size_t size)
@@ -8,8 +10,46 @@ IzSQLUtilities::SQLRow::SQLRow(std::size_t size)
     m_rowData.reserve(size);
 }
 
+IzSQLUtilities::SQLRow::SQLRow(std::size_t size, std::shared_ptr<const SQLRowSource> source, std::size_t sourceRow)
+    : m_size(size)
+    , m_source(std::move(source))
+    , m_sourceRow(sourceRow)
+{
+}
+
+IzSQLUtilities::SQLRow::SQLRow(const SQLRow& other)
+    : m_size(other.m_size)
+    , m_source(other.m_source)
+    , m_sourceRow(other.m_sourceRow)
+    , m_changes(other.m_changes ? std::make_unique<RowChanges>(*other.m_changes) : nullptr)
+{
+    QMutexLocker locker(&other.m_decodeMutex);
+    m_rowData = other.m_rowData;
+    m_cellStates = other.m_cellStates;
+}
+
+IzSQLUtilities::SQLRow& IzSQLUtilities::SQLRow::operator=(const SQLRow& other)
+{
+    if (this != &other) {
+        m_size = other.m_size;
+        m_changes = other.m_changes ? std::make_unique<RowChanges>(*other.m_changes) : nullptr;
+        m_source = other.m_source;
+        m_sourceRow = other.m_sourceRow;
+
+        QMutexLocker locker(&other.m_decodeMutex);
+        m_rowData = other.m_rowData;
+        m_cellStates = other.m_cellStates;
+    }
+    return *this;
+}
+
 void IzSQLUtilities::SQLRow::addColumnValue(const QVariant& value)
 {
+    if (m_source) {
+        qCritical() << "Cannot add new value to lazy SQL data row.";
+        return;
+    }
+
     if (m_rowData.size() + 1 > m_size) {
         qCritical() << "Cannot add new value to this SQL data row. Row is already at maximum capacity.";
         return;
@@ -19,18 +59,197 @@ void IzSQLUtilities::SQLRow::addColumnValue(const QVariant& value)
 
 bool IzSQLUtilities::SQLRow::setColumnValue(int index, const QVariant& value)
 {
-    if (index < 0 || static_cast<std::size_t>(index) > m_size) {
+    if (index < 0 || static_cast<std::size_t>(index) >= m_size) {
         qCritical() << "Got invalid index for this data row:" << index;
         return false;
     }
+
+    QMutexLocker locker(&m_decodeMutex);
+    decode(index);
+
+    auto& originalValues = changes().originalValues;
+    auto it = originalValues.constFind(index);
+
+    if (it == originalValues.cend()) {
+        originalValues.insert(index, m_rowData[index]);
+    } else if (it.value() == value) {
+        originalValues.remove(index);
+    }
+
+    // value and cell state are published together - readers on worker threads hold the same lock
     m_rowData[index] = value;
+    if (!m_cellStates.empty()) {
+        m_cellStates[static_cast<std::size_t>(index)] = CellState::Changed;
+    }
     return true;
 }
 
 QVariant IzSQLUtilities::SQLRow::columnValue(int index) const
 {
-    if (index < 0 || static_cast<std::size_t>(index) > m_size) {
+    if (index < 0 || static_cast<std::size_t>(index) >= m_size) {
         qCritical() << "Got invalid index for this data row:" << index;
     }
+
+    // pending cells of eager rows are filled by GUI thread while workers read them - states are allocated before the row is shared
+    if (m_source || !m_cellStates.empty()) {
+        QMutexLocker locker(&m_decodeMutex);
+        decode(index);
+        return m_rowData[index];
+    }
+
     return m_rowData[index];
 }
+
+bool IzSQLUtilities::SQLRow::isDirty() const
+{
+    return m_changes && !m_changes->originalValues.isEmpty();
+}
+
+bool IzSQLUtilities::SQLRow::isDirty(int index) const
+{
+    return m_changes && m_changes->originalValues.contains(index);
+}
+
+QList<int> IzSQLUtilities::SQLRow::dirtyColumns() const
+{
+    if (!m_changes) {
+        return {};
+    }
+
+    auto columns = m_changes->originalValues.keys();
+    std::sort(columns.begin(), columns.end());
+
+    return columns;
+}
+
+QVariant IzSQLUtilities::SQLRow::originalValue(int index) const
+{
+    if (m_changes) {
+        auto it = m_changes->originalValues.constFind(index);
+        if (it != m_changes->originalValues.cend()) {
+            return it.value();
+        }
+    }
+
+    return columnValue(index);
+}
+
+bool IzSQLUtilities::SQLRow::isAdded() const
+{
+    return m_changes && m_changes->added;
+}
+
+void IzSQLUtilities::SQLRow::setAdded(bool added)
+{
+    if (isAdded() != added) {
+        changes().added = added;
+        changes().originalValues.clear();
+    }
+}
+
+bool IzSQLUtilities::SQLRow::toBeRemoved() const
+{
+    return m_changes && m_changes->toBeRemoved;
+}
+
+void IzSQLUtilities::SQLRow::setToBeRemoved(bool toBeRemoved)
+{
+    if (this->toBeRemoved() != toBeRemoved) {
+        changes().toBeRemoved = toBeRemoved;
+    }
+}
+
+void IzSQLUtilities::SQLRow::clearChanges()
+{
+    m_changes.reset();
+}
+
+const IzSQLUtilities::SQLRowSource* IzSQLUtilities::SQLRow::source() const
+{
+    return m_source.get();
+}
+
+int IzSQLUtilities::SQLRow::dictionaryCode(int index) const
+{
+    const qint64 row = sourceRow(index);
+    return row >= 0 ? m_source->dictionaryCode(static_cast<std::size_t>(row), index) : -1;
+}
+
+qint64 IzSQLUtilities::SQLRow::sourceRow(int index) const
+{
+    if (!m_source || index < 0 || static_cast<std::size_t>(index) >= m_size) {
+        return -1;
+    }
+
+    QMutexLocker locker(&m_decodeMutex);
+    if (!m_cellStates.empty() && m_cellStates[static_cast<std::size_t>(index)] != CellState::Encoded && m_cellStates[static_cast<std::size_t>(index)] != CellState::Decoded) {
+        return -1;
+    }
+
+    return static_cast<qint64>(m_sourceRow);
+}
+
+void IzSQLUtilities::SQLRow::setPending(const std::vector<int>& indexes)
+{
+    QMutexLocker locker(&m_decodeMutex);
+    if (m_cellStates.empty()) {
+        m_rowData.resize(m_size);
+        m_cellStates.resize(m_size, m_source ? CellState::Encoded : CellState::Decoded);
+    }
+
+    for (const int index : indexes) {
+        if (index >= 0 && static_cast<std::size_t>(index) < m_size) {
+            m_cellStates[static_cast<std::size_t>(index)] = CellState::Pending;
+        }
+    }
+}
+
+bool IzSQLUtilities::SQLRow::isPending(int index) const
+{
+    if (index < 0 || static_cast<std::size_t>(index) >= m_size) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_decodeMutex);
+    return !m_cellStates.empty() && m_cellStates[static_cast<std::size_t>(index)] == CellState::Pending;
+}
+
+void IzSQLUtilities::SQLRow::setFetchedValue(int index, const QVariant& value)
+{
+    if (index < 0 || static_cast<std::size_t>(index) >= m_size) {
+        return;
+    }
+
+    QMutexLocker locker(&m_decodeMutex);
+    if (m_cellStates.empty() || m_cellStates[static_cast<std::size_t>(index)] != CellState::Pending) {
+        return;
+    }
+
+    m_rowData[static_cast<std::size_t>(index)] = value;
+    m_cellStates[static_cast<std::size_t>(index)] = CellState::Fetched;
+}
+
+IzSQLUtilities::SQLRow::RowChanges& IzSQLUtilities::SQLRow::changes()
+{
+    if (!m_changes) {
+        m_changes = std::make_unique<RowChanges>();
+    }
+    return *m_changes;
+}
+
+void IzSQLUtilities::SQLRow::decode(int index) const
+{
+    if (!m_source) {
+        return;
+    }
+
+    if (m_cellStates.empty()) {
+        m_rowData.resize(m_size);
+        m_cellStates.resize(m_size, CellState::Encoded);
+    }
+
+    if (m_cellStates[static_cast<std::size_t>(index)] == CellState::Encoded) {
+        m_rowData[static_cast<std::size_t>(index)] = m_source->value(m_sourceRow, index);
+        m_cellStates[static_cast<std::size_t>(index)] = CellState::Decoded;
+    }
+}
@@ -0,0 +1,34 @@
+﻿#include "IzSQLUtilities/SQLRowBatch.h"
+
+#include <QDebug>
+
+void IzSQLUtilities::SQLRowBatch::reset(const QStringList& columnNames, int capacity)
+{
+    m_columnNames = columnNames;
+    m_values.resize(static_cast<std::size_t>(capacity) * static_cast<std::size_t>(columnNames.size()));
+    m_rowCount = 0;
+}
+
+void IzSQLUtilities::SQLRowBatch::setRowCount(int rowCount)
+{
+    if (rowCount < 0 || static_cast<std::size_t>(rowCount) * static_cast<std::size_t>(m_columnNames.size()) > m_values.size()) {
+        qCritical() << "Got invalid row count for this batch:" << rowCount;
+        return;
+    }
+    m_rowCount = rowCount;
+}
+
+int IzSQLUtilities::SQLRowBatch::rowCount() const
+{
+    return m_rowCount;
+}
+
+int IzSQLUtilities::SQLRowBatch::columnCount() const
+{
+    return static_cast<int>(m_columnNames.size());
+}
+
+const QStringList& IzSQLUtilities::SQLRowBatch::columnNames() const
+{
+    return m_columnNames;
+}
@@ -0,0 +1,100 @@
+﻿#include "SQLSchema.h"
+
+#include <QMutex>
+#include <QSqlField>
+#include <QSqlRecord>
+
+namespace
+{
+    // maximum number of cached schemas
+    constexpr int maxCachedSchemas{ 256 };
+}   // namespace
+
+IzSQLUtilities::SQLSchema::SQLSchema(const QSqlRecord& record, const QHash<QString, QMetaType>& declaredTypes)
+{
+    const int columnCount = record.count();
+    m_columnIndexMap.reserve(columnCount);
+    m_dataTypes.reserve(static_cast<std::size_t>(columnCount));
+
+    for (int i = 0; i < columnCount; ++i) {
+        const QSqlField field = record.field(i);
+        m_dataTypes.emplace_back(declaredTypes.value(field.name(), field.metaType()));
+        m_columnIndexMap.insert(field.name(), i);
+        m_indexColumnMap.insert(i, field.name());
+    }
+}
+
+IzSQLUtilities::SQLSchema::SQLSchema(const QMap<int, QString>& indexColumnMap, const std::vector<QMetaType>& dataTypes)
+    : m_indexColumnMap(indexColumnMap)
+    , m_dataTypes(dataTypes)
+{
+    QMapIterator<int, QString> it(m_indexColumnMap);
+    while (it.hasNext()) {
+        it.next();
+        m_columnIndexMap.insert(it.value(), it.key());
+    }
+}
+
+std::shared_ptr<const IzSQLUtilities::SQLSchema> IzSQLUtilities::SQLSchema::fromRecord(const QString& key, const QSqlRecord& record, const QHash<QString, QMetaType>& declaredTypes)
+{
+    static QMutex mutex;
+    static QHash<QString, std::shared_ptr<const SQLSchema>> schemas;
+
+    QMutexLocker locker(&mutex);
+
+    auto it = schemas.constFind(key);
+    if (it != schemas.cend() && it.value()->matches(record, declaredTypes)) {
+        return it.value();
+    }
+
+    if (schemas.size() >= maxCachedSchemas) {
+        schemas.clear();
+    }
+
+    auto schema = std::make_shared<const SQLSchema>(record, declaredTypes);
+    schemas.insert(key, schema);
+
+    return schema;
+}
+
+std::shared_ptr<const IzSQLUtilities::SQLSchema> IzSQLUtilities::SQLSchema::empty()
+{
+    static const auto schema = std::make_shared<const SQLSchema>();
+    return schema;
+}
+
+bool IzSQLUtilities::SQLSchema::matches(const QSqlRecord& record, const QHash<QString, QMetaType>& declaredTypes) const
+{
+    if (record.count() != columnCount()) {
+        return false;
+    }
+
+    for (int i = 0; i < record.count(); ++i) {
+        const QSqlField field = record.field(i);
+        if (declaredTypes.value(field.name(), field.metaType()) != m_dataTypes[static_cast<std::size_t>(i)] || field.name() != m_indexColumnMap.value(i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int IzSQLUtilities::SQLSchema::columnCount() const
+{
+    return static_cast<int>(m_dataTypes.size());
+}
+
+const QHash<QString, int>& IzSQLUtilities::SQLSchema::columnIndexMap() const
+{
+    return m_columnIndexMap;
+}
+
+const QMap<int, QString>& IzSQLUtilities::SQLSchema::indexColumnMap() const
+{
+    return m_indexColumnMap;
+}
+
+const std::vector<QMetaType>& IzSQLUtilities::SQLSchema::dataTypes() const
+{
+    return m_dataTypes;
+}
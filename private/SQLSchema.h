@@ -0,0 +1,57 @@
+﻿#ifndef IZSQLUTILITIES_SQLSCHEMA_H
+#define IZSQLUTILITIES_SQLSCHEMA_H
+
+#include <memory>
+#include <vector>
+
+#include <QHash>
+#include <QMap>
+#include <QMetaType>
+
+class QSqlRecord;
+
+namespace IzSQLUtilities
+{
+    // immutable column layout of loaded sql data - shared by every data set with the same layout
+    class SQLSchema
+    {
+    public:
+        // ctor - empty schema
+        SQLSchema() = default;
+
+        // ctor - schema of given record, declared types replace types of the record's fields of the same names
+        explicit SQLSchema(const QSqlRecord& record, const QHash<QString, QMetaType>& declaredTypes = {});
+
+        // ctor
+        SQLSchema(const QMap<int, QString>& indexColumnMap, const std::vector<QMetaType>& dataTypes);
+
+        // returns schema of given record, reusing schema cached for given key if the layout did not change
+        static std::shared_ptr<const SQLSchema> fromRecord(const QString& key, const QSqlRecord& record, const QHash<QString, QMetaType>& declaredTypes = {});
+
+        // returns shared empty schema
+        static std::shared_ptr<const SQLSchema> empty();
+
+        // returns true if given record, with given declared types, has the same column names and types
+        bool matches(const QSqlRecord& record, const QHash<QString, QMetaType>& declaredTypes = {}) const;
+
+        // returns number of columns
+        int columnCount() const;
+
+        // layout getters
+        const QHash<QString, int>& columnIndexMap() const;
+        const QMap<int, QString>& indexColumnMap() const;
+        const std::vector<QMetaType>& dataTypes() const;
+
+    private:
+        // map of column -> index relations
+        QHash<QString, int> m_columnIndexMap;
+
+        // map of index -> column relations
+        QMap<int, QString> m_indexColumnMap;
+
+        // sql column data types
+        std::vector<QMetaType> m_dataTypes;
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLSCHEMA_H
@@ -0,0 +1,163 @@
+﻿#include "IzSQLUtilities/SQLSelectionStore.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QtAlgorithms>
+
+namespace
+{
+    constexpr std::size_t wordIndex(int row)
+    {
+        return static_cast<std::size_t>(row) >> 6;
+    }
+
+    constexpr std::uint64_t bitMask(int row)
+    {
+        return std::uint64_t{ 1 } << (static_cast<std::size_t>(row) & 63);
+    }
+}   // namespace
+
+int IzSQLUtilities::SQLSelectionStore::size() const
+{
+    return m_size;
+}
+
+void IzSQLUtilities::SQLSelectionStore::resize(int size)
+{
+    if (size < 0) {
+        qCritical() << "Got invalid size for selection store:" << size;
+        return;
+    }
+
+    m_size = size;
+    m_words.resize((static_cast<std::size_t>(size) + 63) >> 6, 0);
+    clearTrailingBits();
+}
+
+void IzSQLUtilities::SQLSelectionStore::insertRows(int row, int count)
+{
+    if (row < 0 || row > m_size || count <= 0) {
+        qCritical() << "Got invalid row range for selection store insert:" << row << count;
+        return;
+    }
+
+    const int oldSize = m_size;
+    resize(m_size + count);
+
+    // shift selection of rows past insertion point
+    for (int i = oldSize - 1; i >= row; --i) {
+        setSelected(i + count, isSelected(i));
+    }
+    setRangeSelected(row, row + count - 1, false);
+}
+
+void IzSQLUtilities::SQLSelectionStore::removeRows(int row, int count)
+{
+    if (row < 0 || count <= 0 || row + count > m_size) {
+        qCritical() << "Got invalid row range for selection store remove:" << row << count;
+        return;
+    }
+
+    // shift selection of rows past removed range
+    for (int i = row + count; i < m_size; ++i) {
+        setSelected(i - count, isSelected(i));
+    }
+    resize(m_size - count);
+}
+
+bool IzSQLUtilities::SQLSelectionStore::setSelected(int row, bool selected)
+{
+    if (row < 0 || row >= m_size) {
+        qCritical() << "Got invalid row for selection store:" << row;
+        return false;
+    }
+
+    auto& word = m_words[wordIndex(row)];
+    const auto old = word;
+    word = selected ? (word | bitMask(row)) : (word & ~bitMask(row));
+
+    return old != word;
+}
+
+bool IzSQLUtilities::SQLSelectionStore::setRangeSelected(int first, int last, bool selected)
+{
+    if (first < 0 || last >= m_size || first > last) {
+        qCritical() << "Got invalid row range for selection store:" << first << last;
+        return false;
+    }
+
+    bool changed{ false };
+    const std::size_t firstWord = wordIndex(first);
+    const std::size_t lastWord = wordIndex(last);
+
+    for (std::size_t w = firstWord; w <= lastWord; ++w) {
+        std::uint64_t mask = ~std::uint64_t{ 0 };
+        if (w == firstWord) {
+            mask &= ~(bitMask(first) - 1);
+        }
+        if (w == lastWord && (static_cast<std::size_t>(last) & 63) != 63) {
+            mask &= (bitMask(last) << 1) - 1;
+        }
+
+        const auto old = m_words[w];
+        m_words[w] = selected ? (old | mask) : (old & ~mask);
+        changed = changed || old != m_words[w];
+    }
+
+    return changed;
+}
+
+void IzSQLUtilities::SQLSelectionStore::selectAll()
+{
+    std::fill(m_words.begin(), m_words.end(), ~std::uint64_t{ 0 });
+    clearTrailingBits();
+}
+
+void IzSQLUtilities::SQLSelectionStore::clear()
+{
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+void IzSQLUtilities::SQLSelectionStore::invert()
+{
+    for (auto& word : m_words) {
+        word = ~word;
+    }
+    clearTrailingBits();
+}
+
+int IzSQLUtilities::SQLSelectionStore::selectedCount() const
+{
+    int count{ 0 };
+    for (const auto word : m_words) {
+        count += static_cast<int>(qPopulationCount(static_cast<quint64>(word)));
+    }
+
+    return count;
+}
+
+QList<int> IzSQLUtilities::SQLSelectionStore::selectedRows() const
+{
+    QList<int> rows;
+    rows.reserve(selectedCount());
+
+    for (std::size_t w = 0; w < m_words.size(); ++w) {
+        auto word = m_words[w];
+        while (word != 0) {
+            const int bit = qCountTrailingZeroBits(static_cast<quint64>(word));
+            rows.append(static_cast<int>((w << 6) + static_cast<std::size_t>(bit)));
+            word &= word - 1;
+        }
+    }
+
+    return rows;
+}
+
+void IzSQLUtilities::SQLSelectionStore::clearTrailingBits()
+{
+    const auto usedBits = static_cast<std::size_t>(m_size) & 63;
+    if (usedBits != 0 && !m_words.empty()) {
+        m_words.back() &= (std::uint64_t{ 1 } << usedBits) - 1;
+    }
+}
@@ -0,0 +1,243 @@
+﻿#include "SQLSnapshot.h"
+
+#include <algorithm>
+
+#include <QDataStream>
+#include <QDebug>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include "LoadedSQLData.h"
+
+namespace
+{
+    // file identifier
+    constexpr char snapshotMagic[]{ "IZSQLSNP" };
+
+    // version of QDataStream used by the format
+    constexpr QDataStream::Version streamVersion{ QDataStream::Qt_6_0 };
+
+    // writes big endian quint64
+    bool writeOffset(QIODevice& device, quint64 value)
+    {
+        const quint64 bigEndian = qToBigEndian(value);
+        return device.write(reinterpret_cast<const char*>(&bigEndian), sizeof(bigEndian)) == sizeof(bigEndian);
+    }
+}   // namespace
+
+IzSQLUtilities::SQLSnapshot::~SQLSnapshot()
+{
+    if (m_data != nullptr) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+}
+
+bool IzSQLUtilities::SQLSnapshot::save(const QString& filePath, const std::vector<std::shared_ptr<SQLRow>>& rows, const QMap<int, QString>& indexColumnMap, const std::vector<QMetaType>& dataTypes)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open snapshot file:" << filePath << "-" << file.errorString();
+        return false;
+    }
+
+    const int columnCount = indexColumnMap.size();
+    const auto rowCount = static_cast<quint64>(rows.size());
+
+    // header
+    {
+        QDataStream out(&file);
+        out.setVersion(streamVersion);
+        out.writeRawData(snapshotMagic, sizeof(snapshotMagic) - 1);
+        out << formatVersion << rowCount << static_cast<qint32>(columnCount);
+
+        for (int c = 0; c < columnCount; ++c) {
+            out << indexColumnMap.value(c) << static_cast<qint32>(static_cast<std::size_t>(c) < dataTypes.size() ? dataTypes[static_cast<std::size_t>(c)].id() : QMetaType::UnknownType);
+        }
+
+        if (out.status() != QDataStream::Ok) {
+            file.cancelWriting();
+            return false;
+        }
+    }
+
+    // columns
+    std::vector<ColumnLayout> columns;
+    columns.reserve(static_cast<std::size_t>(columnCount));
+
+    for (int c = 0; c < columnCount; ++c) {
+        QByteArray cells;
+        std::vector<quint64> offsets;
+        offsets.reserve(rows.size() + 1);
+
+        {
+            QDataStream out(&cells, QIODevice::WriteOnly);
+            out.setVersion(streamVersion);
+            for (const auto& row : rows) {
+                offsets.push_back(static_cast<quint64>(cells.size()));
+                out << row->columnValue(c);
+            }
+            offsets.push_back(static_cast<quint64>(cells.size()));
+        }
+
+        ColumnLayout layout{ static_cast<quint64>(file.pos()), 0 };
+        for (const auto offset : offsets) {
+            writeOffset(file, offset);
+        }
+        layout.cells = static_cast<quint64>(file.pos());
+
+        if (file.write(cells) != cells.size()) {
+            file.cancelWriting();
+            return false;
+        }
+        columns.push_back(layout);
+    }
+
+    // column table and trailer
+    const auto columnTable = static_cast<quint64>(file.pos());
+    for (const auto& column : columns) {
+        writeOffset(file, column.offsets);
+        writeOffset(file, column.cells);
+    }
+    writeOffset(file, columnTable);
+
+    if (!file.commit()) {
+        qWarning() << "Could not write snapshot file:" << filePath << "-" << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<IzSQLUtilities::LoadedSQLData> IzSQLUtilities::SQLSnapshot::load(const QString& filePath)
+{
+    auto snapshot = std::make_shared<SQLSnapshot>();
+    snapshot->m_file.setFileName(filePath);
+
+    if (!snapshot->m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open snapshot file:" << filePath << "-" << snapshot->m_file.errorString();
+        return nullptr;
+    }
+
+    snapshot->m_size = static_cast<quint64>(snapshot->m_file.size());
+    snapshot->m_data = snapshot->m_file.map(0, snapshot->m_file.size());
+    if (snapshot->m_data == nullptr || snapshot->m_size < sizeof(quint64)) {
+        qWarning() << "Could not map snapshot file:" << filePath;
+        return nullptr;
+    }
+
+    // header
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(snapshot->m_data), static_cast<qsizetype>(snapshot->m_size));
+    QDataStream in(raw);
+    in.setVersion(streamVersion);
+
+    char magic[sizeof(snapshotMagic) - 1];
+    quint32 version{ 0 };
+    qint32 columnCount{ 0 };
+
+    if (in.readRawData(magic, sizeof(magic)) != sizeof(magic) || qstrncmp(magic, snapshotMagic, sizeof(magic)) != 0) {
+        qWarning() << "File:" << filePath << "is not a valid snapshot.";
+        return nullptr;
+    }
+
+    in >> version >> snapshot->m_rowCount >> columnCount;
+    if (version != formatVersion) {
+        qWarning() << "Snapshot file:" << filePath << "has unsupported version:" << version;
+        return nullptr;
+    }
+
+    // every row takes at least one offset of every column and every column takes two offsets of the column table
+    const quint64 maxOffsets = snapshot->m_size / sizeof(quint64);
+    if (columnCount < 0 || static_cast<quint64>(columnCount) > maxOffsets / 2 || snapshot->m_rowCount >= maxOffsets) {
+        qWarning() << "Snapshot file:" << filePath << "has corrupted header.";
+        return nullptr;
+    }
+
+    QMap<int, QString> indexColumnMap;
+    std::vector<QMetaType> dataTypes;
+    dataTypes.reserve(static_cast<std::size_t>(std::max(columnCount, 0)));
+
+    for (int c = 0; c < columnCount; ++c) {
+        QString name;
+        qint32 typeId{ QMetaType::UnknownType };
+        in >> name >> typeId;
+
+        indexColumnMap.insert(c, name);
+        dataTypes.emplace_back(typeId);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Snapshot file:" << filePath << "has corrupted header.";
+        return nullptr;
+    }
+
+    // column table
+    const quint64 columnTable = snapshot->readOffset(snapshot->m_size - sizeof(quint64));
+    if (columnTable > snapshot->m_size - sizeof(quint64) || snapshot->m_size - sizeof(quint64) - columnTable != static_cast<quint64>(columnCount) * 2 * sizeof(quint64)) {
+        qWarning() << "Snapshot file:" << filePath << "has corrupted column table.";
+        return nullptr;
+    }
+
+    // all offsets are checked here - value() reads them without checks
+    const quint64 offsetsSize = (snapshot->m_rowCount + 1) * sizeof(quint64);
+    snapshot->m_columns.reserve(static_cast<std::size_t>(columnCount));
+    for (int c = 0; c < columnCount; ++c) {
+        const quint64 position = columnTable + static_cast<quint64>(c) * 2 * sizeof(quint64);
+        const ColumnLayout layout{ snapshot->readOffset(position), snapshot->readOffset(position + sizeof(quint64)) };
+
+        if (layout.offsets > layout.cells || layout.cells > columnTable || layout.cells - layout.offsets != offsetsSize) {
+            qWarning() << "Snapshot file:" << filePath << "has corrupted layout of column:" << c;
+            return nullptr;
+        }
+
+        // cell offsets have to grow and stay within the file
+        const quint64 cellsSize = columnTable - layout.cells;
+        quint64 previous{ 0 };
+        for (quint64 r = 0; r <= snapshot->m_rowCount; ++r) {
+            const quint64 offset = snapshot->readOffset(layout.offsets + r * sizeof(quint64));
+            if (offset < previous || offset > cellsSize) {
+                qWarning() << "Snapshot file:" << filePath << "has corrupted cell offsets of column:" << c;
+                return nullptr;
+            }
+            previous = offset;
+        }
+
+        snapshot->m_columns.push_back(layout);
+    }
+
+    // lazy rows
+    auto sqlData = std::make_shared<LoadedSQLData>();
+    sqlData->setSchema(std::make_shared<const SQLSchema>(indexColumnMap, dataTypes));
+    sqlData->sqlData().reserve(static_cast<std::size_t>(snapshot->m_rowCount));
+
+    for (quint64 r = 0; r < snapshot->m_rowCount; ++r) {
+        sqlData->addRow(std::make_shared<SQLRow>(static_cast<std::size_t>(columnCount), snapshot, static_cast<std::size_t>(r)));
+    }
+
+    return sqlData;
+}
+
+QVariant IzSQLUtilities::SQLSnapshot::value(std::size_t row, int column) const
+{
+    const auto& layout = m_columns[static_cast<std::size_t>(column)];
+    const quint64 begin = readOffset(layout.offsets + row * sizeof(quint64));
+    const quint64 end = readOffset(layout.offsets + (row + 1) * sizeof(quint64));
+
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(m_data + layout.cells + begin), static_cast<qsizetype>(end - begin));
+    QDataStream in(raw);
+    in.setVersion(streamVersion);
+
+    QVariant value;
+    in >> value;
+
+    return value;
+}
+
+qint64 IzSQLUtilities::SQLSnapshot::estimatedSize() const
+{
+    return static_cast<qint64>(m_size);
+}
+
+quint64 IzSQLUtilities::SQLSnapshot::readOffset(quint64 position) const
+{
+    return qFromBigEndian<quint64>(m_data + position);
+}
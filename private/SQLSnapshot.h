@@ -0,0 +1,86 @@
+﻿#ifndef IZSQLUTILITIES_SQLSNAPSHOT_H
+#define IZSQLUTILITIES_SQLSNAPSHOT_H
+
+#include <memory>
+#include <vector>
+
+#include <QFile>
+#include <QMap>
+#include <QMetaType>
+
+#include "IzSQLUtilities/SQLRow.h"
+#include "IzSQLUtilities/SQLRowSource.h"
+
+namespace IzSQLUtilities
+{
+    class LoadedSQLData;
+
+    // versioned, column oriented binary snapshot of loaded sql data
+    //
+    // layout:
+    //  header      - QDataStream: magic, version, row count, column count, column names and type ids
+    //  columns     - per column: (row count + 1) big endian quint64 cell offsets, followed by QDataStream encoded cells
+    //  column table - per column: big endian quint64 position of its offsets and of its cells
+    //  trailer     - big endian quint64 position of the column table
+    //
+    // loaded snapshot is memory mapped and its cells are decoded only when rows access them
+    class SQLSnapshot : public SQLRowSource
+    {
+    public:
+        // current version of the format
+        static constexpr quint32 formatVersion{ 1 };
+
+        // ctor
+        SQLSnapshot() = default;
+
+        // dtor - unmaps file
+        ~SQLSnapshot() override;
+
+        SQLSnapshot(const SQLSnapshot& other) = delete;
+        SQLSnapshot(SQLSnapshot&& other) = delete;
+
+        // writes given rows and schema to file at given path - file is replaced atomically
+        static bool save(const QString& filePath, const std::vector<std::shared_ptr<SQLRow>>& rows, const QMap<int, QString>& indexColumnMap, const std::vector<QMetaType>& dataTypes);
+
+        // maps file at given path and returns lazy data set backed by it, or nullptr on error
+        // header, column table and all cell offsets are validated against the file size - truncated or corrupted files are rejected
+        static std::shared_ptr<LoadedSQLData> load(const QString& filePath);
+
+        // SQLRowSource interface start
+
+        QVariant value(std::size_t row, int column) const override;
+        qint64 estimatedSize() const override;
+
+        // SQLRowSource interface end
+
+    private:
+        // position of column's data in the file
+        struct ColumnLayout {
+            // position of cell offsets
+            quint64 offsets;
+
+            // position of cells
+            quint64 cells;
+        };
+
+        // mapped file
+        QFile m_file;
+
+        // mapped file data
+        const uchar* m_data{ nullptr };
+
+        // size of mapped data
+        quint64 m_size{ 0 };
+
+        // number of rows in the snapshot
+        quint64 m_rowCount{ 0 };
+
+        // layout of columns
+        std::vector<ColumnLayout> m_columns;
+
+        // reads big endian quint64 at given position
+        quint64 readOffset(quint64 position) const;
+    };
+}   // namespace IzSQLUtilities
+
+#endif   // IZSQLUTILITIES_SQLSNAPSHOT_H
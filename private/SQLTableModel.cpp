@@ -1,10 +1,89 @@
 ﻿#include "IzSQLUtilities/SQLTableModel.h"
 
+#include <algorithm>
+
 #include <QDebug>
+#include <QSqlDriver>
+
+#include "IzSQLUtilities/SQLConnector.h"
+#include "IzSQLUtilities/SQLErrorEvent.h"
+
+#include "SQLBatchQuery.h"
+
+namespace
+{
+    // rows submitted with the same statement
+    struct SubmitGroup {
+        // INSERT, UPDATE or DELETE
+        QString operation;
+
+        // generated statement
+        QString sqlDefinition;
+
+        // columnar values bound to the statement
+        std::vector<QVariantList> columns;
+
+        // model rows of the group, -1 for rows already removed from the model
+        QList<int> rows;
+
+        // key column generated by the database for inserted rows or -1
+        int generatedKey{ -1 };
+    };
+
+    // returns group for given statement, creating it if needed
+    SubmitGroup& submitGroup(std::vector<SubmitGroup>& groups, QHash<QString, std::size_t>& groupIndexes, const QString& operation, const QString& sqlDefinition, int columnsCount)
+    {
+        auto it = groupIndexes.constFind(sqlDefinition);
+        if (it != groupIndexes.cend()) {
+            return groups[it.value()];
+        }
+
+        groupIndexes.insert(sqlDefinition, groups.size());
+        groups.push_back({ operation, sqlDefinition, std::vector<QVariantList>(static_cast<std::size_t>(columnsCount)), {}, -1 });
+        return groups.back();
+    }
+
+    // returns error map reported by submitFailed()
+    QVariantMap submitError(int row, const QString& operation, const QString& error)
+    {
+        return { { QStringLiteral("row"), row }, { QStringLiteral("operation"), operation }, { QStringLiteral("error"), error } };
+    }
+}   // namespace
 
 IzSQLUtilities::SQLTableModel::SQLTableModel(QObject* parent)
     : AbstractSQLModel(parent)
 {
+    // keep selection store in sync with model rows
+    connect(this, &SQLTableModel::modelReset, this, [this]() {
+        m_selection.clear();
+        m_selection.resize(rowCount());
+        emit selectionChanged();
+    });
+
+    connect(this, &SQLTableModel::rowsInserted, this, [this](const QModelIndex& parent, int first, int last) {
+        Q_UNUSED(parent)
+        m_selection.insertRows(first, last - first + 1);
+
+        // rows inserted post load are added ones - indexes past the data are skipped in case rows were announced without being stored
+        for (int i = first; i <= last && i < rowCount(); ++i) {
+            detachRow(i).setAdded(true);
+        }
+    });
+
+    connect(this, &SQLTableModel::rowsAboutToBeRemoved, this, [this](const QModelIndex& parent, int first, int last) {
+        Q_UNUSED(parent)
+        onRowsAboutToBeRemoved(first, last);
+    });
+
+    connect(this, &SQLTableModel::modelReset, this, [this]() {
+        m_removedRows.clear();
+    });
+
+    connect(this, &SQLTableModel::rowsRemoved, this, [this](const QModelIndex& parent, int first, int last) {
+        Q_UNUSED(parent)
+        m_selection.removeRows(first, last - first + 1);
+        emit selectionChanged();
+    });
 }
 
 QVariant IzSQLUtilities::SQLTableModel::data(const QModelIndex& index, int role) const
@@ -14,7 +93,19 @@ QVariant IzSQLUtilities::SQLTableModel::data(const QModelIndex& index, int role)
     }
     switch (static_cast<SQLTableModel::SQLTableModelRoles>(role)) {
     case SQLTableModel::SQLTableModelRoles::DisplayData:
+        // deferred cell is fetched on first read
+        if (internalData()[index.row()]->isPending(index.column())) {
+            requestDeferredValue(index.row(), index.column());
+        }
         return internalData()[index.row()]->columnValue(index.column());
+    case SQLTableModel::SQLTableModelRoles::IsAdded:
+        return internalData()[index.row()]->isAdded();
+    case SQLTableModel::SQLTableModelRoles::ToBeRemoved:
+        return internalData()[index.row()]->toBeRemoved();
+    case SQLTableModel::SQLTableModelRoles::IsDirty:
+        return internalData()[index.row()]->isDirty(index.column());
+    case SQLTableModel::SQLTableModelRoles::IsSelected:
+        return m_selection.isSelected(index.row());
     default:
         return {};
     }
@@ -28,12 +119,19 @@ bool IzSQLUtilities::SQLTableModel::setData(const QModelIndex& index, const QVar
     }
     // TODO: for now, only EditRole can be changed, small hack
     if ((role == Qt::DisplayRole || role == Qt::EditRole) && data(index, Qt::DisplayRole) != value) {
-        auto res = internalData()[index.row()]->setColumnValue(index.column(), value);
+        auto res = detachRow(index.row()).setColumnValue(index.column(), value);
         if (res) {
-            emit dataChanged(index, index, { Qt::DisplayRole });
+            emit dataChanged(index, index, { Qt::DisplayRole, static_cast<int>(SQLTableModel::SQLTableModelRoles::IsDirty) });
         }
         return res;
     }
+
+    // marks whole row for removal
+    if (role == static_cast<int>(SQLTableModel::SQLTableModelRoles::ToBeRemoved) && data(index, role) != value) {
+        detachRow(index.row()).setToBeRemoved(value.toBool());
+        emit dataChanged(this->index(index.row(), 0), this->index(index.row(), columnCount() - 1), { role });
+        return true;
+    }
     return false;
 }
 
@@ -47,10 +145,12 @@ Qt::ItemFlags IzSQLUtilities::SQLTableModel::flags(const QModelIndex& index) con
 
 bool IzSQLUtilities::SQLTableModel::insertRows(int row, int count, const QModelIndex& parent)
 {
-    beginInsertRows(parent, row, row + count - 1);
-    // FIXME: Implement me!
-    endInsertRows();
-    return {};
+    // flat model - rows have no children
+    if (parent.isValid()) {
+        return false;
+    }
+
+    return insertDefaultRows(row, count);
 }
 
 bool IzSQLUtilities::SQLTableModel::insertColumns(int column, int count, const QModelIndex& parent)
@@ -77,9 +177,19 @@ bool IzSQLUtilities::SQLTableModel::removeColumns(int column, int count, const Q
     return {};
 }
 
+QStringList IzSQLUtilities::SQLTableModel::rowKeyColumns() const
+{
+    return m_keyColumns;
+}
+
 void IzSQLUtilities::SQLTableModel::additionalDataParsing(bool dataRefreshSucceeded)
 {
     if (dataRefreshSucceeded) {
+        // role names do not depend on the column layout
+        if (!schemaChanged()) {
+            return;
+        }
+
         QHash<int, QByteArray> rn;
         rn.insert(static_cast<int>(SQLTableModel::SQLTableModelRoles::DisplayData), QByteArrayLiteral("displayData"));
         rn.insert(static_cast<int>(SQLTableModel::SQLTableModelRoles::IsAdded), QByteArrayLiteral("isAdded"));
@@ -92,3 +202,471 @@ void IzSQLUtilities::SQLTableModel::additionalDataParsing(bool dataRefreshSuccee
         clearCachedRoleNames();
     }
 }
+
+bool IzSQLUtilities::SQLTableModel::isRowSelected(int row) const
+{
+    return indexIsValid(row) && m_selection.isSelected(row);
+}
+
+void IzSQLUtilities::SQLTableModel::setRowSelected(int row, bool selected)
+{
+    if (!indexIsValid(row)) {
+        qCritical() << "Cannot change selection of row:" << row << "- index is invalid.";
+        return;
+    }
+
+    if (m_selection.setSelected(row, selected)) {
+        notifySelectionChanged(row, row);
+    }
+}
+
+void IzSQLUtilities::SQLTableModel::setRowRangeSelected(int first, int last, bool selected)
+{
+    if (!indexIsValid(first) || !indexIsValid(last) || first > last) {
+        qCritical() << "Cannot change selection of rows:" << first << "-" << last << "- range is invalid.";
+        return;
+    }
+
+    if (m_selection.setRangeSelected(first, last, selected)) {
+        notifySelectionChanged(first, last);
+    }
+}
+
+void IzSQLUtilities::SQLTableModel::setRowsSelected(const QList<int>& rows, bool selected)
+{
+    int first{ rowCount() };
+    int last{ -1 };
+
+    for (const auto row : rows) {
+        if (indexIsValid(row) && m_selection.setSelected(row, selected)) {
+            first = std::min(first, row);
+            last = std::max(last, row);
+        }
+    }
+
+    if (last != -1) {
+        notifySelectionChanged(first, last);
+    }
+}
+
+void IzSQLUtilities::SQLTableModel::selectAll()
+{
+    if (rowCount() == 0) {
+        return;
+    }
+
+    m_selection.selectAll();
+    notifySelectionChanged(0, rowCount() - 1);
+}
+
+void IzSQLUtilities::SQLTableModel::clearSelection()
+{
+    if (rowCount() == 0) {
+        return;
+    }
+
+    m_selection.clear();
+    notifySelectionChanged(0, rowCount() - 1);
+}
+
+void IzSQLUtilities::SQLTableModel::invertSelection()
+{
+    if (rowCount() == 0) {
+        return;
+    }
+
+    m_selection.invert();
+    notifySelectionChanged(0, rowCount() - 1);
+}
+
+QList<int> IzSQLUtilities::SQLTableModel::selectedRows() const
+{
+    return m_selection.selectedRows();
+}
+
+int IzSQLUtilities::SQLTableModel::selectedRowsCount() const
+{
+    return m_selection.selectedCount();
+}
+
+const IzSQLUtilities::SQLSelectionStore& IzSQLUtilities::SQLTableModel::selectionStore() const
+{
+    return m_selection;
+}
+
+void IzSQLUtilities::SQLTableModel::notifySelectionChanged(int first, int last)
+{
+    emit dataChanged(index(first, 0), index(last, std::max(columnCount() - 1, 0)), { static_cast<int>(SQLTableModel::SQLTableModelRoles::IsSelected) });
+    emit selectionChanged();
+}
+
+QString IzSQLUtilities::SQLTableModel::tableName() const
+{
+    return m_tableName;
+}
+
+void IzSQLUtilities::SQLTableModel::setTableName(const QString& tableName)
+{
+    if (m_tableName != tableName) {
+        m_tableName = tableName;
+        emit tableNameChanged();
+    }
+}
+
+QStringList IzSQLUtilities::SQLTableModel::keyColumns() const
+{
+    return m_keyColumns;
+}
+
+void IzSQLUtilities::SQLTableModel::setKeyColumns(const QStringList& keyColumns)
+{
+    if (m_keyColumns != keyColumns) {
+        m_keyColumns = keyColumns;
+        emit keyColumnsChanged();
+    }
+}
+
+int IzSQLUtilities::SQLTableModel::submitChunkSize() const
+{
+    return m_submitChunkSize;
+}
+
+void IzSQLUtilities::SQLTableModel::setSubmitChunkSize(int submitChunkSize)
+{
+    if (submitChunkSize <= 0) {
+        qWarning() << "Got invalid submit chunk size:" << submitChunkSize;
+        return;
+    }
+
+    if (m_submitChunkSize != submitChunkSize) {
+        m_submitChunkSize = submitChunkSize;
+        emit submitChunkSizeChanged();
+    }
+}
+
+bool IzSQLUtilities::SQLTableModel::hasChanges() const
+{
+    if (!m_removedRows.isEmpty()) {
+        return true;
+    }
+
+    return std::any_of(cbegin(), cend(), [](const auto& row) -> bool {
+        return row->isAdded() || row->toBeRemoved() || row->isDirty();
+    });
+}
+
+bool IzSQLUtilities::SQLTableModel::submitChanges()
+{
+    if (isRefreshingData()) {
+        qCritical() << "Cannot submit changes - model is still loading data.";
+        return false;
+    }
+
+    if (m_tableName.isEmpty()) {
+        qCritical() << "Cannot submit changes - table name was not set.";
+        return false;
+    }
+
+    QList<int> keyIndexes;
+    for (const auto& column : qAsConst(m_keyColumns)) {
+        const int keyIndex = columnIndexMap().value(column, -1);
+        if (keyIndex == -1) {
+            qCritical() << "Cannot submit changes - key column:" << column << "was not found in model's columns.";
+            return false;
+        }
+        keyIndexes.append(keyIndex);
+    }
+
+    if (!hasChanges()) {
+        emit changesSubmitted();
+        return true;
+    }
+
+    SqlConnector db(databaseType(), connectionParameters());
+    if (!db.getConnection().isOpen()) {
+        SQLErrorEvent::postSQLError(db.lastError());
+        return false;
+    }
+
+    QSqlDatabase database = db.getConnection();
+    QSqlDriver* driver = database.driver();
+    const QString table = driver->escapeIdentifier(m_tableName, QSqlDriver::TableName);
+
+    // WHERE clause identifying row by its key columns
+    QStringList keyConditions;
+    for (const auto keyIndex : qAsConst(keyIndexes)) {
+        keyConditions.append(driver->escapeIdentifier(columnNameFromIndex(keyIndex), QSqlDriver::FieldName) + QStringLiteral(" = ?"));
+    }
+    const QString keyCondition = keyConditions.join(QStringLiteral(" AND "));
+
+    // group changes by generated statement - DELETEs first, then UPDATEs and INSERTs
+    std::vector<SubmitGroup> groups;
+    QHash<QString, std::size_t> groupIndexes;
+
+    // rows with NULL key values would match nothing - e.g. added rows whose generated keys were not read back
+    QVariantList keyErrors;
+    const auto hasNullKey = [&](int row, const QString& operation, const auto& keyValue) {
+        for (const auto keyIndex : qAsConst(keyIndexes)) {
+            if (keyValue(keyIndex).isNull()) {
+                keyErrors.append(submitError(row, operation, QStringLiteral("Key column %1 is NULL.").arg(columnNameFromIndex(keyIndex))));
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const auto addDelete = [&](int row, const auto& keyValue) {
+        if (hasNullKey(row, QStringLiteral("DELETE"), keyValue)) {
+            return;
+        }
+
+        auto& group = submitGroup(groups, groupIndexes, QStringLiteral("DELETE"), QStringLiteral("DELETE FROM ") + table + QStringLiteral(" WHERE ") + keyCondition, keyIndexes.size());
+        for (int k = 0; k < keyIndexes.size(); ++k) {
+            group.columns[static_cast<std::size_t>(k)].append(keyValue(keyIndexes[k]));
+        }
+        group.rows.append(row);
+    };
+
+    for (const auto& removedRow : qAsConst(m_removedRows)) {
+        addDelete(-1, [&removedRow](int column) {
+            return removedRow.value(column);
+        });
+    }
+
+    for (int i = 0; i < rowCount(); ++i) {
+        const auto& row = cbegin()[i];
+        if (row->toBeRemoved() && !row->isAdded()) {
+            addDelete(i, [&row](int column) {
+                return row->originalValue(column);
+            });
+        }
+    }
+
+    for (int i = 0; i < rowCount(); ++i) {
+        const auto& row = cbegin()[i];
+        if (row->toBeRemoved() || row->isAdded() || !row->isDirty()) {
+            continue;
+        }
+
+        if (hasNullKey(i, QStringLiteral("UPDATE"), [&row](int column) { return row->originalValue(column); })) {
+            continue;
+        }
+
+        const auto dirtyColumns = row->dirtyColumns();
+        QStringList assignments;
+        for (const auto column : dirtyColumns) {
+            assignments.append(driver->escapeIdentifier(columnNameFromIndex(column), QSqlDriver::FieldName) + QStringLiteral(" = ?"));
+        }
+
+        auto& group = submitGroup(groups, groupIndexes, QStringLiteral("UPDATE"),
+                                  QStringLiteral("UPDATE ") + table + QStringLiteral(" SET ") + assignments.join(QStringLiteral(", ")) + QStringLiteral(" WHERE ") + keyCondition,
+                                  dirtyColumns.size() + keyIndexes.size());
+        std::size_t c{ 0 };
+        for (const auto column : dirtyColumns) {
+            group.columns[c++].append(row->columnValue(column));
+        }
+        for (const auto keyIndex : qAsConst(keyIndexes)) {
+            group.columns[c++].append(row->originalValue(keyIndex));
+        }
+        group.rows.append(i);
+    }
+
+    for (int i = 0; i < rowCount(); ++i) {
+        const auto& row = cbegin()[i];
+        if (!row->isAdded() || row->toBeRemoved()) {
+            continue;
+        }
+
+        // NULL columns are left to database defaults - this also covers identity keys, read back after the insert
+        QList<int> columns;
+        QStringList names;
+        for (int column = 0; column < columnCount(); ++column) {
+            if (!row->columnValue(column).isNull()) {
+                columns.append(column);
+                names.append(driver->escapeIdentifier(columnNameFromIndex(column), QSqlDriver::FieldName));
+            }
+        }
+
+        if (columns.isEmpty()) {
+            qWarning() << "Skipping added row:" << i << "- all of its columns are NULL.";
+            continue;
+        }
+
+        QStringList placeholders;
+        placeholders.fill(QStringLiteral("?"), columns.size());
+
+        auto& group = submitGroup(groups, groupIndexes, QStringLiteral("INSERT"),
+                                  QStringLiteral("INSERT INTO ") + table + QStringLiteral(" (") + names.join(QStringLiteral(", ")) + QStringLiteral(") VALUES (") + placeholders.join(QStringLiteral(", ")) + QStringLiteral(")"),
+                                  columns.size());
+        for (int c = 0; c < columns.size(); ++c) {
+            group.columns[static_cast<std::size_t>(c)].append(row->columnValue(columns[c]));
+        }
+        group.rows.append(i);
+
+        // single NULL key column is generated by the database - it is read back after the insert
+        if (keyIndexes.size() == 1 && !columns.contains(keyIndexes.first())) {
+            group.generatedKey = keyIndexes.first();
+        } else if (std::any_of(keyIndexes.cbegin(), keyIndexes.cend(), [&columns](int keyIndex) { return !columns.contains(keyIndex); })) {
+            qWarning() << "Generated keys of added row:" << i << "can not be read back - row can not be changed until the model is refreshed.";
+        }
+    }
+
+    if (!keyErrors.isEmpty()) {
+        qCritical() << "Cannot submit changes - rows with NULL key values can not be updated or deleted.";
+        emit submitFailed(keyErrors);
+        return false;
+    }
+
+    const bool readsGeneratedKeys = driver->hasFeature(QSqlDriver::LastInsertId);
+    if (!readsGeneratedKeys && std::any_of(groups.cbegin(), groups.cend(), [](const auto& group) { return group.generatedKey != -1; })) {
+        qWarning() << "Driver can not read back generated keys - added rows can not be changed until the model is refreshed.";
+    }
+
+    if (keyIndexes.isEmpty() && std::any_of(groups.cbegin(), groups.cend(), [](const auto& group) { return group.operation != QStringLiteral("INSERT"); })) {
+        qCritical() << "Cannot submit changes - key columns are required for UPDATE and DELETE statements.";
+        return false;
+    }
+
+    // execute groups in chunks inside one transaction
+    if (!database.transaction()) {
+        SQLErrorEvent::postSQLError(database.lastError());
+        return false;
+    }
+
+    // failed rows - single row if statements run row by row, whole chunk if native batch failed, none if statement could not be prepared
+    const SubmitGroup* failedGroup{ nullptr };
+    int failedOffset{ 0 };
+    int failedCount{ 0 };
+    QSqlError failedError;
+
+    // model row -> key generated for it
+    QHash<int, QVariant> generatedKeys;
+
+    for (const auto& group : groups) {
+        SQLBatchQuery query(database);
+        if (!query.prepare(group.sqlDefinition)) {
+            failedGroup = &group;
+            failedError = query.lastError();
+            break;
+        }
+
+        // generated keys are read row by row - native batch does not report them
+        if (group.generatedKey != -1 && readsGeneratedKeys) {
+            for (int r = 0; r < group.rows.size(); ++r) {
+                if (!query.execRow(group.columns, r)) {
+                    failedGroup = &group;
+                    failedOffset = r;
+                    failedCount = 1;
+                    failedError = query.lastError();
+                    break;
+                }
+                const auto generatedKey = query.lastInsertId();
+                if (generatedKey.isValid()) {
+                    generatedKeys.insert(group.rows[r], generatedKey);
+                }
+            }
+
+            if (failedGroup != nullptr) {
+                break;
+            }
+            continue;
+        }
+
+        for (int offset = 0; offset < group.rows.size(); offset += m_submitChunkSize) {
+            const int count = std::min(m_submitChunkSize, static_cast<int>(group.rows.size()) - offset);
+            int failedRow{ -1 };
+            if (!query.exec(group.columns, offset, count, failedRow)) {
+                failedGroup = &group;
+                failedOffset = failedRow == -1 ? offset : failedRow;
+                failedCount = failedRow == -1 ? count : 1;
+                failedError = query.lastError();
+                break;
+            }
+        }
+
+        if (failedGroup != nullptr) {
+            break;
+        }
+    }
+
+    if (failedGroup == nullptr && database.commit()) {
+        qInfo() << "Submitted changes of table:" << m_tableName << "in" << groups.size() << "statement groups.";
+
+        // generated keys are accepted as loaded values - rows are removed below, so indexes are still valid
+        const int keyIndex = keyIndexes.isEmpty() ? -1 : keyIndexes.first();
+        for (auto it = generatedKeys.cbegin(); it != generatedKeys.cend(); ++it) {
+            detachRow(it.key()).setColumnValue(keyIndex, it.value());
+        }
+
+        // removed rows are gone from the database now
+        m_submitting = true;
+        for (int i = rowCount() - 1; i >= 0; --i) {
+            if (cbegin()[i]->toBeRemoved()) {
+                removeRow(i);
+            }
+        }
+        m_submitting = false;
+
+        for (int i = 0; i < rowCount(); ++i) {
+            if (at(i).isDirty() || at(i).isAdded()) {
+                detachRow(i).clearChanges();
+            }
+        }
+        m_removedRows.clear();
+
+        if (rowCount() > 0) {
+            emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1),
+                             { static_cast<int>(SQLTableModel::SQLTableModelRoles::IsAdded),
+                               static_cast<int>(SQLTableModel::SQLTableModelRoles::ToBeRemoved),
+                               static_cast<int>(SQLTableModel::SQLTableModelRoles::IsDirty) });
+        }
+        emit changesSubmitted();
+
+        return true;
+    }
+
+    if (failedGroup == nullptr) {
+        failedError = database.lastError();
+    }
+    database.rollback();
+    SQLErrorEvent::postSQLError(failedError);
+
+    // driver reports only the failed statement - without native batch it is the failed row, with native batch the failed chunk
+    QVariantList errors;
+    if (failedGroup != nullptr && failedCount == 0) {
+        errors.append(submitError(-1, failedGroup->operation, failedError.text()));
+    } else if (failedGroup != nullptr) {
+        for (int r = failedOffset; r < failedOffset + failedCount; ++r) {
+            errors.append(submitError(failedGroup->rows[r], failedGroup->operation, failedError.text()));
+        }
+    } else {
+        errors.append(submitError(-1, QStringLiteral("COMMIT"), failedError.text()));
+    }
+
+    qCritical() << "Could not submit changes of table:" << m_tableName << "-" << errors.size() << "rows failed.";
+    emit submitFailed(errors);
+
+    return false;
+}
+
+void IzSQLUtilities::SQLTableModel::onRowsAboutToBeRemoved(int first, int last)
+{
+    if (m_submitting) {
+        return;
+    }
+
+    // rows loaded from database have to be deleted there on submit
+    for (int i = first; i <= last; ++i) {
+        const auto& row = cbegin()[i];
+        if (row->isAdded()) {
+            continue;
+        }
+
+        QVariantList values;
+        values.reserve(columnCount());
+        for (int column = 0; column < columnCount(); ++column) {
+            values.append(row->originalValue(column));
+        }
+        m_removedRows.append(values);
+    }
+}
@@ -1,11 +1,42 @@
 ﻿#include "IzSQLUtilities/SQLTableProxyModel.h"
 
+#include <memory>
+#include <vector>
+
 #include <QDebug>
 #include <QItemSelectionModel>
 #include <QThread>
 #include <QtConcurrent>
 
 #include "IzSQLUtilities/SQLTableModel.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
+
+namespace
+{
+    // returns true if given value lies in inclusive [from, to] range, null bound means unbounded
+    bool inRange(const QVariant& value, const QVariant& from, const QVariant& to)
+    {
+        if (value.isNull()) {
+            return false;
+        }
+
+        if (!from.isNull()) {
+            const auto order = QVariant::compare(value, from);
+            if (order != QPartialOrdering::Greater && order != QPartialOrdering::Equivalent) {
+                return false;
+            }
+        }
+
+        if (!to.isNull()) {
+            const auto order = QVariant::compare(value, to);
+            if (order != QPartialOrdering::Less && order != QPartialOrdering::Equivalent) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}   // namespace
 
 IzSQLUtilities::SQLTableProxyModel::SQLTableProxyModel(QObject* parent)
     : QSortFilterProxyModel(parent)
@@ -28,11 +59,21 @@ IzSQLUtilities::SQLTableProxyModel::SQLTableProxyModel(QObject* parent)
             m_filtersApplied = false;
             m_filteredIndexes.clear();
             m_filters.clear();
+            m_rangeFilters.clear();
         } else {
             filterData();
         }
     });
 
+    // snapshot replaces whole data set
+    connect(m_sourceModel, &SQLTableModel::snapshotLoaded, this, [this]() {
+        m_filtersApplied = false;
+        m_filteredIndexes.clear();
+        m_filters.clear();
+        m_rangeFilters.clear();
+        invalidateFilter();
+    });
+
     connect(this, &SQLTableProxyModel::isFilteringChanged, this, [this]() {
         if (isFiltering()) {
             emit m_sourceModel->layoutAboutToBeChanged();
@@ -52,6 +93,17 @@ void IzSQLUtilities::SQLTableProxyModel::setSourceModel(QAbstractItemModel* sour
     }
 }
 
+void IzSQLUtilities::SQLTableProxyModel::sort(int column, Qt::SortOrder order)
+{
+    const int source = column >= 0 ? sourceColumn(column) : -1;
+    if (source >= 0 && m_sourceModel->isDeferredColumn(source)) {
+        qWarning() << "Cannot sort by deferred column" << m_sourceModel->columnNameFromIndex(source);
+        return;
+    }
+
+    QSortFilterProxyModel::sort(column, order);
+}
+
 bool IzSQLUtilities::SQLTableProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
 {
     Q_UNUSED(source_parent)
@@ -88,6 +140,19 @@ void IzSQLUtilities::SQLTableProxyModel::setExcludedColumns(const QSet<int>& exc
     }
 }
 
+void IzSQLUtilities::SQLTableProxyModel::deferInvisibleColumns()
+{
+    QStringList deferredColumns;
+    for (const int column : m_hiddenColumns + m_excludedColumns) {
+        const QString columnName = m_sourceModel->columnNameFromIndex(column);
+        if (!columnName.isEmpty()) {
+            deferredColumns.append(columnName);
+        }
+    }
+
+    m_sourceModel->setDeferredColumns(deferredColumns);
+}
+
 int IzSQLUtilities::SQLTableProxyModel::sourceRow(int proxyRow) const
 {
     return mapToSource(index(proxyRow, 0)).row();
@@ -143,13 +208,28 @@ void IzSQLUtilities::SQLTableProxyModel::addColumnFilter(int column, const QRegu
 void IzSQLUtilities::SQLTableProxyModel::removeColumnFilter(int column)
 {
     m_filters.remove(column);
-    m_filtersApplied = !m_filters.empty();
+    m_filtersApplied = !m_filters.empty() || !m_rangeFilters.empty();
+    filterData();
+}
+
+void IzSQLUtilities::SQLTableProxyModel::addColumnRangeFilter(int column, const QVariant& from, const QVariant& to)
+{
+    m_rangeFilters.insert(column, qMakePair(from, to));
+    m_filtersApplied = true;
+    filterData();
+}
+
+void IzSQLUtilities::SQLTableProxyModel::removeColumnRangeFilter(int column)
+{
+    m_rangeFilters.remove(column);
+    m_filtersApplied = !m_filters.empty() || !m_rangeFilters.empty();
     filterData();
 }
 
 void IzSQLUtilities::SQLTableProxyModel::clearColumnFilters()
 {
     m_filters.clear();
+    m_rangeFilters.clear();
     m_filtersApplied = false;
     filterData();
 }
@@ -161,7 +241,65 @@ QItemSelectionModel* IzSQLUtilities::SQLTableProxyModel::selectionModel() const
 
 void IzSQLUtilities::SQLTableProxyModel::setSelectionModel(QItemSelectionModel* selectionModel)
 {
+    if (m_selectionModel == selectionModel) {
+        return;
+    }
+
+    if (m_selectionModel != nullptr) {
+        disconnect(m_selectionModel, &QItemSelectionModel::selectionChanged, this, &SQLTableProxyModel::onSelectionModelChanged);
+    }
+
     m_selectionModel = selectionModel;
+
+    if (m_selectionModel != nullptr) {
+        connect(m_selectionModel, &QItemSelectionModel::selectionChanged, this, &SQLTableProxyModel::onSelectionModelChanged);
+    }
+}
+
+void IzSQLUtilities::SQLTableProxyModel::setRowSelected(int proxyRow, bool selected)
+{
+    m_sourceModel->setRowSelected(sourceRow(proxyRow), selected);
+}
+
+void IzSQLUtilities::SQLTableProxyModel::selectFiltered()
+{
+    const int rows = rowCount();
+    if (rows == m_sourceModel->rowCount()) {
+        m_sourceModel->selectAll();
+        return;
+    }
+
+    QList<int> filteredRows;
+    filteredRows.reserve(rows);
+    for (int i{ 0 }; i < rows; ++i) {
+        filteredRows.append(sourceRow(i));
+    }
+    m_sourceModel->setRowsSelected(filteredRows, true);
+}
+
+void IzSQLUtilities::SQLTableProxyModel::onSelectionModelChanged(const QItemSelection& selected, const QItemSelection& deselected)
+{
+    if (!deselected.isEmpty()) {
+        m_sourceModel->setRowsSelected(sourceRows(deselected), false);
+    }
+    if (!selected.isEmpty()) {
+        m_sourceModel->setRowsSelected(sourceRows(selected), true);
+    }
+}
+
+QList<int> IzSQLUtilities::SQLTableProxyModel::sourceRows(const QItemSelection& selection) const
+{
+    QList<int> rows;
+    for (const auto& range : selection) {
+        if (range.model() != this) {
+            continue;
+        }
+        for (int i = range.top(); i <= range.bottom(); ++i) {
+            rows.append(sourceRow(i));
+        }
+    }
+
+    return rows;
 }
 
 void IzSQLUtilities::SQLTableProxyModel::changeColumnVisibilitiy(int column, bool visibility)
@@ -193,7 +331,7 @@ void IzSQLUtilities::SQLTableProxyModel::filterData()
     emit isFilteringChanged();
 
     // if filters are empty reset filtring
-    if (m_filters.isEmpty()) {
+    if (m_filters.isEmpty() && m_rangeFilters.isEmpty()) {
         m_filteredIndexes.clear();
         m_isFiltering = false;
         emit isFilteringChanged();
@@ -201,22 +339,95 @@ void IzSQLUtilities::SQLTableProxyModel::filterData()
         return;
     }
 
+    // pending cells would be filtered as nulls
+    for (const int column : m_filters.keys() + m_rangeFilters.keys()) {
+        if (m_sourceModel->isDeferredColumn(column)) {
+            qWarning() << "Cannot filter deferred column" << m_sourceModel->columnNameFromIndex(column);
+            m_isFiltering = false;
+            emit isFilteringChanged();
+            return;
+        }
+    }
+
     // cache filters and generate index set
     m_cachedFilters = m_filters;
+    m_cachedRangeFilters = m_rangeFilters;
     QSet<int> indexes;
     for (int i{ 0 }; i < m_sourceModel->rowCount(); ++i) {
         indexes.insert(i);
     }
 
+    // filters of dictionary encoded columns are evaluated once per distinct value
+    m_cachedDictionaryMatches.clear();
+    m_cachedRangeMatches.clear();
+    const SQLRowSource* rowSource = m_sourceModel->rowCount() > 0 ? m_sourceModel->at(0).source() : nullptr;
+    m_cachedDictionarySource = rowSource;
+
+    if (rowSource != nullptr) {
+        QHashIterator<int, QRegularExpression> it(m_cachedFilters);
+        while (it.hasNext()) {
+            it.next();
+
+            const int dictionarySize = rowSource->dictionarySize(it.key());
+            if (dictionarySize > 0) {
+                std::vector<bool> matches(static_cast<std::size_t>(dictionarySize));
+                for (int code = 0; code < dictionarySize; ++code) {
+                    matches[static_cast<std::size_t>(code)] = rowSource->dictionaryValue(it.key(), code).toString().contains(it.value());
+                }
+                m_cachedDictionaryMatches.insert(it.key(), std::move(matches));
+            }
+        }
+
+        // range filters of packed columns are evaluated once per source row on packed blocks
+        QHashIterator<int, QPair<QVariant, QVariant>> rangeIt(m_cachedRangeFilters);
+        while (rangeIt.hasNext()) {
+            rangeIt.next();
+
+            auto matches = rowSource->rangeMatches(rangeIt.key(), rangeIt.value().first, rangeIt.value().second);
+            if (!matches.empty()) {
+                m_cachedRangeMatches.insert(rangeIt.key(), std::move(matches));
+            }
+        }
+    }
+
+    // rows are shared with the source model while filtering - it copies them before changing, so workers read stable rows
+    auto rows = std::make_shared<const std::vector<std::shared_ptr<SQLRow>>>(m_sourceModel->cbegin(), m_sourceModel->cend());
+
     // launch concurrent filtering
     QFuture<QSet<int>> filteredData = QtConcurrent::filteredReduced<QSet<int>>(
+        SQLThreadPool::computeInstance(),
         indexes,
-        [this](int row) {
+        [this, rows](int row) {
+            const SQLRow& sqlRow = *(*rows)[static_cast<std::size_t>(row)];
+            const bool sameSource = sqlRow.source() != nullptr && sqlRow.source() == m_cachedDictionarySource;
+
+            QHashIterator<int, QPair<QVariant, QVariant>> rangeIt(m_cachedRangeFilters);
+            while (rangeIt.hasNext()) {
+                rangeIt.next();
+
+                const auto matches = sameSource ? m_cachedRangeMatches.constFind(rangeIt.key()) : m_cachedRangeMatches.cend();
+                const qint64 encodedRow = matches != m_cachedRangeMatches.cend() ? sqlRow.sourceRow(rangeIt.key()) : -1;
+                if (encodedRow >= 0) {
+                    if (!(*matches)[static_cast<std::size_t>(encodedRow)]) {
+                        return false;
+                    }
+                } else if (!inRange(sqlRow.columnValue(rangeIt.key()), rangeIt.value().first, rangeIt.value().second)) {
+                    return false;
+                }
+            }
+
             int hits{ 0 };
             QHashIterator<int, QRegularExpression> it(m_cachedFilters);
             while (it.hasNext()) {
                 it.next();
-                if (m_sourceModel->at(row).columnValue(it.key()).toString().contains(it.value())) {
+
+                const auto matches = sameSource ? m_cachedDictionaryMatches.constFind(it.key()) : m_cachedDictionaryMatches.cend();
+                const int code = matches != m_cachedDictionaryMatches.cend() ? sqlRow.dictionaryCode(it.key()) : -1;
+                if (code >= 0) {
+                    if ((*matches)[static_cast<std::size_t>(code)]) {
+                        hits++;
+                    }
+                } else if (sqlRow.columnValue(it.key()).toString().contains(it.value())) {
                     hits++;
                 }
             }
@@ -228,17 +439,35 @@ void IzSQLUtilities::SQLTableProxyModel::filterData()
     m_filterFutureWatcher->setFuture(filteredData);
 }
 
-IzSQLUtilities::SQLTableModel* IzSQLUtilities::SQLTableProxyModel::source() const
+bool IzSQLUtilities::SQLTableProxyModel::lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const
 {
-    return m_sourceModel;
+    // reading pending cells would fetch whole deferred column - rows keep source order instead
+    if (m_sourceModel->isDeferredColumn(source_left.column())) {
+        return source_left.row() < source_right.row();
+    }
+
+    // dictionary ranks follow case sensitive QString::compare() - same order as the default implementation
+    if (sortRole() == static_cast<int>(SQLTableModel::SQLTableModelRoles::DisplayData) && !isSortLocaleAware() && sortCaseSensitivity() == Qt::CaseSensitive
+        && source_left.column() == source_right.column()) {
+        const SQLRow& left = m_sourceModel->at(source_left.row());
+        const SQLRow& right = m_sourceModel->at(source_right.row());
+
+        if (left.source() != nullptr && left.source() == right.source()) {
+            const int leftCode = left.dictionaryCode(source_left.column());
+            const int rightCode = right.dictionaryCode(source_right.column());
+
+            if (leftCode >= 0 && rightCode >= 0) {
+                return left.source()->dictionaryRank(source_left.column(), leftCode) < left.source()->dictionaryRank(source_right.column(), rightCode);
+            }
+        }
+    }
+
+    return QSortFilterProxyModel::lessThan(source_left, source_right);
 }
 
-QVariant IzSQLUtilities::SQLTableProxyModel::data(const QModelIndex& index, int role) const
+IzSQLUtilities::SQLTableModel* IzSQLUtilities::SQLTableProxyModel::source() const
 {
-    if (m_selectionModel != nullptr && role == static_cast<int>(SQLTableModel::SQLTableModelRoles::IsSelected)) {
-        return m_selectionModel->isSelected(index);
-    }
-    return QSortFilterProxyModel::data(index, role);
+    return m_sourceModel;
 }
 
 QVariant IzSQLUtilities::SQLTableProxyModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -0,0 +1,219 @@
+﻿#include "IzSQLUtilities/SQLThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+namespace
+{
+    // task waiting to be started
+    struct QueuedTask {
+        std::function<void()> task;
+
+        // measures wait time of the task
+        QElapsedTimer queueTimer;
+    };
+
+    // tasks of a single target
+    struct TargetQueue {
+        // maximum number of running tasks - -1 means default limit
+        int maxConcurrency{ -1 };
+
+        // number of tasks started in the pool
+        int running{ 0 };
+
+        // waiting tasks, by priority
+        std::deque<QueuedTask> interactive;
+        std::deque<QueuedTask> background;
+    };
+
+    // state of the dispatcher
+    struct Dispatcher {
+        QMutex mutex;
+
+        // target -> its tasks
+        QHash<QString, TargetQueue> targets;
+
+        // limit of targets without own one
+        int defaultMaxConcurrency{ 4 };
+
+        // statistics
+        std::atomic<int> queuedTasks{ 0 };
+        std::atomic<int> runningTasks{ 0 };
+        std::atomic<quint64> startedTasks{ 0 };
+        std::atomic<qint64> totalWaitTime{ 0 };
+        std::atomic<qint64> maxWaitTime{ 0 };
+    };
+
+    Dispatcher& dispatcher()
+    {
+        static Dispatcher dispatcher;
+        return dispatcher;
+    }
+
+    // starts waiting tasks of given target as long as its limit allows - dispatcher mutex has to be locked
+    void startTasks(const QString& target);
+
+    // executes task in the pool
+    void executeTask(const QString& target, QueuedTask queuedTask)
+    {
+        auto& d = dispatcher();
+
+        const qint64 waitTime = queuedTask.queueTimer.nsecsElapsed() / 1000;
+        d.queuedTasks--;
+        d.runningTasks++;
+        d.startedTasks++;
+        d.totalWaitTime += waitTime;
+
+        qint64 maxWaitTime = d.maxWaitTime;
+        while (waitTime > maxWaitTime && !d.maxWaitTime.compare_exchange_weak(maxWaitTime, waitTime)) {
+        }
+
+        queuedTask.task();
+        d.runningTasks--;
+
+        QMutexLocker locker(&d.mutex);
+        d.targets[target].running--;
+        startTasks(target);
+    }
+
+    void startTasks(const QString& target)
+    {
+        auto& d = dispatcher();
+        auto& queue = d.targets[target];
+
+        const int maxConcurrency = queue.maxConcurrency == -1 ? d.defaultMaxConcurrency : queue.maxConcurrency;
+        while ((maxConcurrency <= 0 || queue.running < maxConcurrency) && (!queue.interactive.empty() || !queue.background.empty())) {
+            const bool interactive = !queue.interactive.empty();
+            auto& tasks = interactive ? queue.interactive : queue.background;
+
+            auto queuedTask = std::make_shared<QueuedTask>(std::move(tasks.front()));
+            tasks.pop_front();
+            queue.running++;
+
+            IzSQLUtilities::SQLThreadPool::instance()->start(
+                [target, queuedTask]() {
+                    executeTask(target, std::move(*queuedTask));
+                },
+                interactive ? 1 : 0);
+        }
+    }
+}   // namespace
+
+QThreadPool* IzSQLUtilities::SQLThreadPool::instance()
+{
+    static QThreadPool pool;
+    static const bool initialized = []() {
+        pool.setObjectName(QStringLiteral("IzSQLUtilities::SQLThreadPool"));
+        pool.setExpiryTimeout(-1);
+        pool.setMaxThreadCount(8);
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    return &pool;
+}
+
+QThreadPool* IzSQLUtilities::SQLThreadPool::computeInstance()
+{
+    static QThreadPool pool;
+    static const bool initialized = []() {
+        pool.setObjectName(QStringLiteral("IzSQLUtilities::SQLThreadPool::compute"));
+        pool.setMaxThreadCount(std::max(QThread::idealThreadCount(), 1));
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    return &pool;
+}
+
+QString IzSQLUtilities::SQLThreadPool::target(DatabaseType databaseType, const QVariantMap& connectionParameters)
+{
+    QString target = QString::number(static_cast<int>(databaseType));
+
+    QMapIterator<QString, QVariant> it(connectionParameters);
+    while (it.hasNext()) {
+        it.next();
+        target += QLatin1Char('\x1f') + it.key() + QLatin1Char('=') + it.value().toString();
+    }
+
+    return target;
+}
+
+int IzSQLUtilities::SQLThreadPool::targetConcurrency(const QString& target)
+{
+    auto& d = dispatcher();
+    QMutexLocker locker(&d.mutex);
+
+    const int maxConcurrency = d.targets.value(target).maxConcurrency;
+    return maxConcurrency == -1 ? d.defaultMaxConcurrency : maxConcurrency;
+}
+
+void IzSQLUtilities::SQLThreadPool::setTargetConcurrency(const QString& target, int maxConcurrency)
+{
+    auto& d = dispatcher();
+    QMutexLocker locker(&d.mutex);
+
+    d.targets[target].maxConcurrency = std::max(maxConcurrency, 0);
+    startTasks(target);
+}
+
+int IzSQLUtilities::SQLThreadPool::defaultTargetConcurrency()
+{
+    auto& d = dispatcher();
+    QMutexLocker locker(&d.mutex);
+
+    return d.defaultMaxConcurrency;
+}
+
+void IzSQLUtilities::SQLThreadPool::setDefaultTargetConcurrency(int maxConcurrency)
+{
+    auto& d = dispatcher();
+    QMutexLocker locker(&d.mutex);
+
+    d.defaultMaxConcurrency = std::max(maxConcurrency, 0);
+
+    const auto targets = d.targets.keys();
+    for (const auto& target : targets) {
+        startTasks(target);
+    }
+}
+
+int IzSQLUtilities::SQLThreadPool::queueDepth(const QString& target)
+{
+    auto& d = dispatcher();
+    QMutexLocker locker(&d.mutex);
+
+    auto it = d.targets.constFind(target);
+    if (it == d.targets.cend()) {
+        return 0;
+    }
+
+    return static_cast<int>(it->interactive.size() + it->background.size());
+}
+
+IzSQLUtilities::SQLThreadPool::Metrics IzSQLUtilities::SQLThreadPool::metrics()
+{
+    auto& d = dispatcher();
+    return { d.queuedTasks, d.runningTasks, d.startedTasks, d.totalWaitTime, d.maxWaitTime };
+}
+
+void IzSQLUtilities::SQLThreadPool::enqueue(const QString& target, Priority priority, std::function<void()> task)
+{
+    auto& d = dispatcher();
+    QMutexLocker locker(&d.mutex);
+
+    QueuedTask queuedTask{ std::move(task), {} };
+    queuedTask.queueTimer.start();
+    d.queuedTasks++;
+
+    auto& queue = d.targets[target];
+    (priority == Priority::Interactive ? queue.interactive : queue.background).push_back(std::move(queuedTask));
+
+    startTasks(target);
+}
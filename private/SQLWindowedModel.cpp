@@ -0,0 +1,653 @@
+﻿#include "IzSQLUtilities/SQLWindowedModel.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include <QDebug>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTimer>
+
+#include "IzSQLUtilities/SQLConnectionPool.h"
+#include "IzSQLUtilities/SQLConnector.h"
+#include "IzSQLUtilities/SQLErrorEvent.h"
+#include "IzSQLUtilities/SQLThreadPool.h"
+
+#include "LoadedSQLData.h"
+#include "SQLColumnType.h"
+#include "SQLQueryTemplate.h"
+#include "SQLSchema.h"
+
+namespace
+{
+    // number of retries of page which failed to load
+    constexpr int maxPageRetries{ 4 };
+
+    // delay before the first retry of failed page, in msecs - doubled by every next one
+    constexpr int pageRetryInterval{ 500 };
+
+    // single page to load
+    struct PageRequest {
+        // sql database type
+        IzSQLUtilities::DatabaseType databaseType;
+
+        // sql connection parameters
+        QVariantMap connectionParameters;
+
+        // normalized query of the result
+        QString sqlQuery;
+
+        // parameters of the query
+        QVariantMap sqlParameters;
+
+        // columns the result is paged by
+        QStringList keyColumns;
+
+        // declared column types
+        QVariantMap columnTypes;
+
+        // number of rows of single page
+        int pageSize{ 0 };
+
+        // position of the first row - used only if the page has no neighbouring keys
+        qint64 offset{ 0 };
+
+        // keys of the last row of previous page - page starts right after them
+        QVariantList afterKeys;
+
+        // keys of the first row of next page - page ends right before them
+        QVariantList beforeKeys;
+
+        // schema cache key - schema is built only for non empty key
+        QString schemaKey;
+    };
+
+    // rows of loaded page
+    struct PageResult {
+        // result of the load
+        IzSQLUtilities::AbstractSQLModel::DataRefreshResult result{ IzSQLUtilities::AbstractSQLModel::DataRefreshResult::QueryError };
+
+        // layout of the rows - set only if requested
+        std::shared_ptr<const IzSQLUtilities::SQLSchema> schema;
+
+        // rows of the page, in order of keys
+        std::vector<std::shared_ptr<IzSQLUtilities::SQLRow>> rows;
+    };
+
+    // returns query selecting rows of requested page
+    // keyset comparison is expanded, so it works with servers without row value comparisons
+    QString pageQuery(const QSqlDatabase& database, const PageRequest& request, QVariantMap& sqlParameters)
+    {
+        const bool descending = !request.beforeKeys.isEmpty();
+        const QVariantList& anchor = descending ? request.beforeKeys : request.afterKeys;
+        const bool mssql = request.databaseType == IzSQLUtilities::DatabaseType::MSSQL;
+
+        QStringList keys;
+        for (const auto& keyColumn : request.keyColumns) {
+            keys.append(database.driver()->escapeIdentifier(keyColumn, QSqlDriver::FieldName));
+        }
+
+        QString query = QStringLiteral("SELECT * FROM (%1) izWindow").arg(IzSQLUtilities::SQLQueryTemplate::wrappable(request.sqlQuery));
+        if (!anchor.isEmpty()) {
+            if (mssql) {
+                query = QStringLiteral("SELECT TOP (%1) * FROM (%2) izWindow").arg(request.pageSize).arg(IzSQLUtilities::SQLQueryTemplate::wrappable(request.sqlQuery));
+            }
+
+            // (k0 > :a0) OR (k0 = :a0 AND k1 > :a1) OR ...
+            QStringList alternatives;
+            for (int i = 0; i < keys.size(); ++i) {
+                QStringList conditions;
+                for (int j = 0; j <= i; ++j) {
+                    const QString parameter = QStringLiteral(":izPageKey%1").arg(j);
+                    conditions.append(QStringLiteral("%1 %2 %3").arg(keys.at(j), j < i ? QStringLiteral("=") : (descending ? QStringLiteral("<") : QStringLiteral(">")), parameter));
+                }
+                alternatives.append(QStringLiteral("(%1)").arg(conditions.join(QStringLiteral(" AND "))));
+            }
+
+            for (int i = 0; i < keys.size(); ++i) {
+                sqlParameters.insert(QStringLiteral(":izPageKey%1").arg(i), anchor.value(i));
+            }
+
+            query += QStringLiteral(" WHERE ") + alternatives.join(QStringLiteral(" OR "));
+        }
+
+        query += QStringLiteral(" ORDER BY ") + keys.join(descending ? QStringLiteral(" DESC, ") : QStringLiteral(", ")) + (descending ? QStringLiteral(" DESC") : QString());
+
+        if (anchor.isEmpty()) {
+            query += mssql ? QStringLiteral(" OFFSET %1 ROWS FETCH NEXT %2 ROWS ONLY").arg(request.offset).arg(request.pageSize) : QStringLiteral(" LIMIT %2 OFFSET %1").arg(request.offset).arg(request.pageSize);
+        } else if (!mssql) {
+            query += QStringLiteral(" LIMIT %1").arg(request.pageSize);
+        }
+
+        return query;
+    }
+
+    // loads requested page on given connection
+    PageResult loadPage(const QSqlDatabase& database, const PageRequest& request)
+    {
+        PageResult page;
+
+        QVariantMap parameters = request.sqlParameters;
+        QSqlQuery query(database);
+        query.setForwardOnly(true);
+        query.prepare(pageQuery(database, request, parameters));
+
+        QMapIterator<QString, QVariant> it(parameters);
+        while (it.hasNext()) {
+            it.next();
+            query.bindValue(it.key(), it.value());
+        }
+
+        if (!query.exec()) {
+            qWarning() << query.lastError();
+            IzSQLUtilities::SQLErrorEvent::postSQLError(query.lastError());
+            return page;
+        }
+
+        // declared column types - cells are coerced once, during load
+        const QSqlRecord record = query.record();
+        const int columnsCount = record.count();
+        std::vector<std::optional<IzSQLUtilities::SQLColumnType>> columnTypes(static_cast<std::size_t>(columnsCount));
+        QHash<QString, QMetaType> declaredTypes;
+        for (int i = 0; i < columnsCount; ++i) {
+            const auto declaration = request.columnTypes.constFind(record.fieldName(i));
+            if (declaration != request.columnTypes.cend()) {
+                auto& columnType = columnTypes[static_cast<std::size_t>(i)];
+                columnType = IzSQLUtilities::SQLColumnType::parse(declaration.value().toString());
+                if (columnType) {
+                    declaredTypes.insert(record.fieldName(i), columnType->metaType());
+                }
+            }
+        }
+
+        if (!request.schemaKey.isEmpty()) {
+            page.schema = IzSQLUtilities::SQLSchema::fromRecord(request.schemaKey, record, declaredTypes);
+        }
+
+        page.rows.reserve(static_cast<std::size_t>(request.pageSize));
+        while (query.next()) {
+            auto row = std::make_shared<IzSQLUtilities::SQLRow>(static_cast<std::size_t>(columnsCount));
+            for (int i = 0; i < columnsCount; ++i) {
+                const auto& columnType = columnTypes[static_cast<std::size_t>(i)];
+                row->addColumnValue(columnType ? columnType->coerce(query.value(i)) : query.value(i));
+            }
+            page.rows.push_back(std::move(row));
+        }
+
+        // page preceding known keys is selected in reverse order
+        if (!request.beforeKeys.isEmpty()) {
+            std::reverse(page.rows.begin(), page.rows.end());
+        }
+
+        page.result = IzSQLUtilities::AbstractSQLModel::DataRefreshResult::Refreshed;
+        return page;
+    }
+}   // namespace
+
+IzSQLUtilities::SQLWindowedModel::SQLWindowedModel(QObject* parent)
+    : AbstractSQLModel(parent)
+    , m_pageLoadTimer(new QTimer(this))
+{
+    m_pageLoadTimer->setSingleShot(true);
+    m_pageLoadTimer->setInterval(0);
+
+    connect(m_pageLoadTimer, &QTimer::timeout, this, &SQLWindowedModel::loadRequestedPages);
+}
+
+int IzSQLUtilities::SQLWindowedModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent)
+    return m_window.rowCount;
+}
+
+QVariant IzSQLUtilities::SQLWindowedModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return {};
+    }
+
+    int column{ -1 };
+    if (role == Qt::DisplayRole) {
+        column = index.column();
+    } else if (role >= Qt::UserRole) {
+        column = role - Qt::UserRole;
+    }
+
+    if (column < 0 || column >= columnCount()) {
+        return {};
+    }
+
+    // rows of pages which are not loaded yet are empty until the page arrives
+    const SQLRow* sqlRow = row(index.row());
+    return sqlRow != nullptr ? sqlRow->columnValue(column) : QVariant();
+}
+
+bool IzSQLUtilities::SQLWindowedModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    Q_UNUSED(index)
+    Q_UNUSED(value)
+    Q_UNUSED(role)
+
+    qWarning() << "SQLWindowedModel is read only.";
+    return false;
+}
+
+bool IzSQLUtilities::SQLWindowedModel::addRow(const QVariantMap& data, bool defaultInitialize, const QStringList& uniqueColumnValues)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(defaultInitialize)
+    Q_UNUSED(uniqueColumnValues)
+
+    qWarning() << "SQLWindowedModel is read only.";
+    return false;
+}
+
+bool IzSQLUtilities::SQLWindowedModel::removeRow(int index)
+{
+    Q_UNUSED(index)
+
+    qWarning() << "SQLWindowedModel is read only.";
+    return false;
+}
+
+bool IzSQLUtilities::SQLWindowedModel::isRowLoaded(int row) const
+{
+    if (row < 0 || row >= m_window.rowCount || m_window.pageSize <= 0) {
+        return false;
+    }
+
+    const auto page = m_pages.constFind(row / m_window.pageSize);
+    return page != m_pages.cend() && static_cast<std::size_t>(row % m_window.pageSize) < page->rows.size();
+}
+
+void IzSQLUtilities::SQLWindowedModel::additionalDataParsing(bool dataRefreshSucceeded)
+{
+    m_pages.clear();
+    m_recentPages.clear();
+    m_loadingPages.clear();
+    m_requestedPages.clear();
+    m_pageFailures.clear();
+    m_endPage = -1;
+    m_firstKeys.clear();
+    m_lastKeys.clear();
+    m_lastReadPage = -1;
+    m_windowGeneration++;
+
+    if (!dataRefreshSucceeded) {
+        m_window = Window();
+        clearCachedRoleNames();
+        return;
+    }
+
+    m_window = std::exchange(m_loadedWindow, Window());
+    if (!m_window.firstPage.empty()) {
+        const int firstPageRows = static_cast<int>(m_window.firstPage.size());
+        insertPage(0, std::exchange(m_window.firstPage, {}));
+
+        // model is being reset - short first page is the whole result
+        if (m_endPage != -1) {
+            m_window.rowCount = std::min(m_window.rowCount, firstPageRows);
+        }
+    }
+
+    // same column layout - cached role names are still valid
+    if (!schemaChanged()) {
+        return;
+    }
+
+    QHash<int, QByteArray> rn;
+    QMapIterator<int, QString> it(indexColumnMap());
+
+    while (it.hasNext()) {
+        it.next();
+
+        if (rn.contains(it.key() + Qt::UserRole)) {
+            qWarning() << "Got duplicated column:" << it.value() << "from query. Column will be skipped.";
+        } else {
+            rn.insert(Qt::UserRole + it.key(), it.value().toUtf8());
+        }
+    }
+    cacheRoleNames(rn);
+}
+
+bool IzSQLUtilities::SQLWindowedModel::holdsAllRows() const
+{
+    return false;
+}
+
+QFuture<IzSQLUtilities::AbstractSQLModel::LoadedData> IzSQLUtilities::SQLWindowedModel::startFullRefresh(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    // pages are not shared through SQLResultCache and are never partitioned
+    return SQLThreadPool::run(SQLThreadPool::target(databaseType(), connectionParameters()), SQLThreadPool::Priority::Interactive, [this, sqlQuery, sqlParameters]() -> LoadedData {
+        return loadWindow(sqlQuery, sqlParameters);
+    });
+}
+
+IzSQLUtilities::AbstractSQLModel::LoadedData IzSQLUtilities::SQLWindowedModel::loadWindow(const QString& sqlQuery, const QVariantMap& sqlParameters)
+{
+    emit rowsLoaded(0);
+    emit sqlQueryStarted();
+
+    if (m_keyColumns.isEmpty()) {
+        qCritical() << "Windowed model has no key columns - result can not be paged.";
+        return { AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    auto db = SQLConnectionPool::connection(databaseType(), connectionParameters());
+    if (!db->getConnection().isOpen()) {
+        SQLErrorEvent::postSQLError(db->lastError());
+        return { AbstractSQLModel::DataRefreshResult::DatabaseError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    QSqlDatabase database = db->getConnection();
+
+    // number of rows - exact or estimated
+    int rowCount{ 0 };
+    {
+        QSqlQuery count(database);
+        count.setForwardOnly(true);
+        count.prepare(m_rowCountQuery.isEmpty() ? QStringLiteral("SELECT COUNT(*) FROM (%1) izWindow").arg(SQLQueryTemplate::wrappable(sqlQuery))
+                                                : SQLQueryTemplate::compile(m_rowCountQuery)->normalizedQuery(sqlParameters));
+
+        QMapIterator<QString, QVariant> it(sqlParameters);
+        while (it.hasNext()) {
+            it.next();
+            count.bindValue(it.key(), it.value());
+        }
+
+        if (!count.exec() || !count.next()) {
+            qWarning() << count.lastError();
+            SQLErrorEvent::postSQLError(count.lastError());
+            return { AbstractSQLModel::DataRefreshResult::QueryError, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+        }
+
+        rowCount = static_cast<int>(std::clamp<qint64>(count.value(0).toLongLong(), 0, std::numeric_limits<int>::max()));
+    }
+
+    emit sqlQueryReturned();
+
+    if (abortRequested()) {
+        return { AbstractSQLModel::DataRefreshResult::Aborted, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    // first page - also defines layout of the result
+    PageRequest request{ databaseType(), connectionParameters(), sqlQuery, sqlParameters, m_keyColumns, columnTypes(), m_pageSize, 0, {}, {}, SQLThreadPool::target(databaseType(), connectionParameters()) + QLatin1Char('\x1e') + sqlQuery };
+    auto page = loadPage(database, request);
+    if (page.result != AbstractSQLModel::DataRefreshResult::Refreshed) {
+        return { page.result, AbstractSQLModel::DataRefreshType::Full, std::shared_ptr<LoadedSQLData>() };
+    }
+
+    emit rowsLoaded(static_cast<int>(page.rows.size()));
+
+    m_loadedWindow = { sqlQuery, sqlParameters, m_keyColumns, m_pageSize, rowCount, std::move(page.rows) };
+
+    // rows are held by pages - model's own data stays empty
+    auto sqlData = std::make_shared<LoadedSQLData>();
+    sqlData->setSchema(page.schema);
+
+    return { AbstractSQLModel::DataRefreshResult::Refreshed, AbstractSQLModel::DataRefreshType::Full, sqlData };
+}
+
+IzSQLUtilities::SQLRow* IzSQLUtilities::SQLWindowedModel::row(int index) const
+{
+    if (m_window.pageSize <= 0) {
+        return nullptr;
+    }
+
+    const int page = index / m_window.pageSize;
+
+    // neighbouring pages are prefetched whenever reading moves to other page
+    if (page != m_lastReadPage) {
+        m_lastReadPage = page;
+        for (int i = page - m_prefetchPages; i <= page + m_prefetchPages; ++i) {
+            requestPage(i);
+        }
+    }
+
+    auto it = m_pages.find(page);
+    if (it == m_pages.end()) {
+        requestPage(page);
+        return nullptr;
+    }
+
+    m_recentPages.splice(m_recentPages.begin(), m_recentPages, it->recent);
+
+    const auto position = static_cast<std::size_t>(index - page * m_window.pageSize);
+    return position < it->rows.size() ? it->rows[position].get() : nullptr;
+}
+
+void IzSQLUtilities::SQLWindowedModel::requestPage(int page) const
+{
+    if (page < 0 || static_cast<qint64>(page) * m_window.pageSize >= m_window.rowCount) {
+        return;
+    }
+
+    if (m_pages.contains(page) || m_loadingPages.contains(page) || (m_endPage != -1 && page >= m_endPage)) {
+        return;
+    }
+
+    m_loadingPages.insert(page);
+    m_requestedPages.append(page);
+    m_pageLoadTimer->start();
+}
+
+void IzSQLUtilities::SQLWindowedModel::loadRequestedPages()
+{
+    const auto pages = std::exchange(m_requestedPages, {});
+    const auto target = SQLThreadPool::target(databaseType(), connectionParameters());
+    const quint64 generation = m_windowGeneration;
+
+    for (const int page : pages) {
+        PageRequest request{ databaseType(), connectionParameters(), m_window.sqlQuery, m_window.sqlParameters, m_window.keyColumns, columnTypes(), m_window.pageSize, static_cast<qint64>(page) * m_window.pageSize, {}, {}, {} };
+
+        // keyset of known neighbour is used if possible - offset has to skip all preceding rows on the server
+        if (m_lastKeys.contains(page - 1)) {
+            request.afterKeys = m_lastKeys.value(page - 1);
+        } else if (m_firstKeys.contains(page + 1)) {
+            request.beforeKeys = m_firstKeys.value(page + 1);
+        }
+
+        // page being read is loaded before prefetched ones
+        const auto priority = page == m_lastReadPage ? SQLThreadPool::Priority::Interactive : SQLThreadPool::Priority::Background;
+
+        SQLThreadPool::run(target, priority, [request]() -> PageResult {
+            auto db = SQLConnectionPool::connection(request.databaseType, request.connectionParameters);
+            if (!db->getConnection().isOpen()) {
+                SQLErrorEvent::postSQLError(db->lastError());
+                return {};
+            }
+
+            return loadPage(db->getConnection(), request);
+        }).then(this, [this, page, generation](const PageResult& result) {
+            // data was replaced in the meantime
+            if (generation != m_windowGeneration) {
+                return;
+            }
+
+            // failed page stays in m_loadingPages until its retry - reads in the meantime do not request it again
+            if (result.result != AbstractSQLModel::DataRefreshResult::Refreshed) {
+                const int failures = ++m_pageFailures[page];
+                if (failures > maxPageRetries) {
+                    qWarning() << "Page" << page << "could not be loaded - it will not be retried until the next refresh.";
+                    return;
+                }
+
+                const int delay = pageRetryInterval << (failures - 1);
+                qWarning() << "Page" << page << "could not be loaded - it will be retried in" << delay << "msecs.";
+
+                QTimer::singleShot(delay, this, [this, page, generation]() {
+                    if (generation == m_windowGeneration) {
+                        m_loadingPages.remove(page);
+                        requestPage(page);
+                    }
+                });
+                return;
+            }
+
+            m_loadingPages.remove(page);
+            m_pageFailures.remove(page);
+
+            // page past the end of overestimated result - it and the following ones are not queried again
+            if (result.rows.empty()) {
+                m_endPage = m_endPage == -1 ? page : std::min(m_endPage, page);
+                trimWindow(page * m_window.pageSize);
+                return;
+            }
+
+            const int rows = static_cast<int>(result.rows.size());
+            insertPage(page, result.rows);
+
+            const int first = page * m_window.pageSize;
+            if (rows < m_window.pageSize) {
+                trimWindow(first + rows);
+            }
+
+            // page loaded before an earlier one trimmed the window has no rows left to update
+            if (first < m_window.rowCount) {
+                emit dataChanged(index(first, 0), index(std::min(first + rows, m_window.rowCount) - 1, columnCount() - 1));
+            }
+        });
+    }
+}
+
+void IzSQLUtilities::SQLWindowedModel::insertPage(int page, std::vector<std::shared_ptr<SQLRow>> rows)
+{
+    storePageKeys(page, rows);
+
+    // short page is the last one of the result
+    if (rows.size() < static_cast<std::size_t>(m_window.pageSize)) {
+        m_endPage = m_endPage == -1 ? page + 1 : std::min(m_endPage, page + 1);
+    }
+
+    m_recentPages.push_front(page);
+    m_pages.insert(page, { std::move(rows), m_recentPages.begin() });
+
+    // least recently read pages are evicted - keys of their boundaries are kept
+    while (m_pages.size() > m_maxCachedPages) {
+        const int evicted = m_recentPages.back();
+        m_recentPages.pop_back();
+        m_pages.remove(evicted);
+    }
+}
+
+void IzSQLUtilities::SQLWindowedModel::trimWindow(int rowCount)
+{
+    if (rowCount < 0 || rowCount >= m_window.rowCount) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), rowCount, m_window.rowCount - 1);
+    m_window.rowCount = rowCount;
+    endRemoveRows();
+}
+
+void IzSQLUtilities::SQLWindowedModel::storePageKeys(int page, const std::vector<std::shared_ptr<SQLRow>>& rows)
+{
+    if (rows.empty()) {
+        return;
+    }
+
+    QVariantList firstKeys;
+    QVariantList lastKeys;
+    for (const auto& keyColumn : std::as_const(m_window.keyColumns)) {
+        const int column = columnIndexMap().value(keyColumn, -1);
+        if (column == -1) {
+            qWarning() << "Key column" << keyColumn << "not found in the result - pages will be loaded by offset.";
+            return;
+        }
+
+        firstKeys.append(rows.front()->columnValue(column));
+        lastKeys.append(rows.back()->columnValue(column));
+    }
+
+    m_firstKeys.insert(page, firstKeys);
+
+    // keyset of the next page is valid only after a full page
+    if (rows.size() == static_cast<std::size_t>(m_window.pageSize)) {
+        m_lastKeys.insert(page, lastKeys);
+    }
+}
+
+QStringList IzSQLUtilities::SQLWindowedModel::keyColumns() const
+{
+    return m_keyColumns;
+}
+
+void IzSQLUtilities::SQLWindowedModel::setKeyColumns(const QStringList& keyColumns)
+{
+    if (m_keyColumns != keyColumns) {
+        m_keyColumns = keyColumns;
+        emit keyColumnsChanged();
+    }
+}
+
+int IzSQLUtilities::SQLWindowedModel::pageSize() const
+{
+    return m_pageSize;
+}
+
+void IzSQLUtilities::SQLWindowedModel::setPageSize(int pageSize)
+{
+    if (pageSize < 1) {
+        qWarning() << "Got invalid page size:" << pageSize;
+        return;
+    }
+
+    if (m_pageSize != pageSize) {
+        m_pageSize = pageSize;
+        emit pageSizeChanged();
+    }
+}
+
+int IzSQLUtilities::SQLWindowedModel::prefetchPages() const
+{
+    return m_prefetchPages;
+}
+
+void IzSQLUtilities::SQLWindowedModel::setPrefetchPages(int prefetchPages)
+{
+    if (prefetchPages < 0) {
+        qWarning() << "Got invalid number of prefetched pages:" << prefetchPages;
+        return;
+    }
+
+    if (m_prefetchPages != prefetchPages) {
+        m_prefetchPages = prefetchPages;
+        emit prefetchPagesChanged();
+    }
+}
+
+int IzSQLUtilities::SQLWindowedModel::maxCachedPages() const
+{
+    return m_maxCachedPages;
+}
+
+void IzSQLUtilities::SQLWindowedModel::setMaxCachedPages(int maxCachedPages)
+{
+    if (maxCachedPages < 1) {
+        qWarning() << "Got invalid number of cached pages:" << maxCachedPages;
+        return;
+    }
+
+    if (m_maxCachedPages != maxCachedPages) {
+        m_maxCachedPages = maxCachedPages;
+        emit maxCachedPagesChanged();
+    }
+}
+
+QString IzSQLUtilities::SQLWindowedModel::rowCountQuery() const
+{
+    return m_rowCountQuery;
+}
+
+void IzSQLUtilities::SQLWindowedModel::setRowCountQuery(const QString& rowCountQuery)
+{
+    if (m_rowCountQuery != rowCountQuery) {
+        m_rowCountQuery = rowCountQuery;
+        emit rowCountQueryChanged();
+    }
+}
@@ -0,0 +1,135 @@
+﻿#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "IzSQLUtilities/SQLRefreshGroup.h"
+#include "IzSQLUtilities/SQLTableModel.h"
+
+using namespace IzSQLUtilities;
+
+// SQLRefreshGroup against QSQLITE database standing in for the server ones
+class tst_SQLRefreshGroup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    // model queries are loaded into their models
+    void modelQueries();
+
+    // batch result set is loaded into the model
+    void batchResultSet();
+
+    // batch without result set fails and keeps data of the models
+    void batchWithoutResultSet();
+
+private:
+    // database directory
+    QTemporaryDir m_directory;
+
+    // parameters of test database
+    QVariantMap m_connectionParameters;
+
+    // sets up given model to use test database
+    void setupModel(SQLTableModel& model, const QString& sqlQuery = {});
+
+    // refreshes given group and waits for its end - returns refreshEnded() argument
+    bool refresh(SQLRefreshGroup& group);
+};
+
+void tst_SQLRefreshGroup::initTestCase()
+{
+    QVERIFY(m_directory.isValid());
+    m_connectionParameters = { { QStringLiteral("path"), m_directory.path() }, { QStringLiteral("database"), QStringLiteral("test.db") } };
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("setup"));
+        database.setDatabaseName(m_directory.filePath(QStringLiteral("test.db")));
+        QVERIFY(database.open());
+
+        QSqlQuery query(database);
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)")));
+        QVERIFY(query.exec(QStringLiteral("INSERT INTO items (id, name) VALUES (1, 'first'), (2, 'second'), (3, 'third')")));
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("setup"));
+}
+
+void tst_SQLRefreshGroup::modelQueries()
+{
+    SQLTableModel items;
+    setupModel(items, QStringLiteral("SELECT id, name FROM items"));
+
+    SQLTableModel names;
+    setupModel(names, QStringLiteral("SELECT name FROM items WHERE id > 1"));
+
+    SQLRefreshGroup group;
+    group.addModel(&items);
+    group.addModel(&names);
+
+    QVERIFY(refresh(group));
+    QCOMPARE(items.rowCount(), 3);
+    QCOMPARE(names.rowCount(), 2);
+    QCOMPARE(names.at(0).columnValue(names.indexFromColumnName(QStringLiteral("name"))).toString(), QStringLiteral("second"));
+}
+
+void tst_SQLRefreshGroup::batchResultSet()
+{
+    SQLTableModel items;
+    setupModel(items);
+
+    SQLRefreshGroup group;
+    group.addModel(&items);
+    group.setSqlQuery(QStringLiteral("SELECT id, name FROM items WHERE id <= ':maxId'"));
+    group.setSqlQueryParameters({ { QStringLiteral(":maxId"), 2 } });
+
+    QVERIFY(refresh(group));
+    QCOMPARE(items.rowCount(), 2);
+    QCOMPARE(items.at(1).columnValue(items.indexFromColumnName(QStringLiteral("id"))).toInt(), 2);
+}
+
+void tst_SQLRefreshGroup::batchWithoutResultSet()
+{
+    SQLTableModel items;
+    setupModel(items, QStringLiteral("SELECT id, name FROM items"));
+
+    SQLRefreshGroup group;
+    group.addModel(&items);
+    QVERIFY(refresh(group));
+    QCOMPARE(items.rowCount(), 3);
+
+    // row count of the update is not a result set of the model
+    group.setSqlQuery(QStringLiteral("UPDATE items SET name = name"));
+    QVERIFY(!refresh(group));
+    QCOMPARE(items.rowCount(), 3);
+}
+
+void tst_SQLRefreshGroup::setupModel(SQLTableModel& model, const QString& sqlQuery)
+{
+    model.setDatabaseType(DatabaseType::SQLITE);
+    model.setConnectionParameters(m_connectionParameters);
+    if (!sqlQuery.isEmpty()) {
+        model.setSqlQuery(sqlQuery);
+    }
+}
+
+bool tst_SQLRefreshGroup::refresh(SQLRefreshGroup& group)
+{
+    QSignalSpy refreshEnded(&group, &SQLRefreshGroup::refreshEnded);
+    if (!group.refresh()) {
+        return false;
+    }
+
+    if (!refreshEnded.wait(10000)) {
+        qWarning() << "Group refresh did not end.";
+        return false;
+    }
+
+    return refreshEnded.first().first().toBool();
+}
+
+QTEST_GUILESS_MAIN(tst_SQLRefreshGroup)
+
+#include "tst_SQLRefreshGroup.moc"